@@ -354,6 +354,15 @@ struct PACKED log_Rate_Thread_Dt {
     float dtMin;
 };
 
+// rate thread sample to motor output latency
+struct PACKED log_Rate_Thread_Latency {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t latency_avg;
+    uint32_t latency_max;
+    uint8_t batch_max;
+};
+
 // Write a Guided mode position target
 // pos_target is lat, lon, alt OR offset from ekf origin in cm
 // terrain should be 0 if pos_target.z is alt-above-ekf-origin, 1 if alt-above-terrain
@@ -416,6 +425,20 @@ void Copter::Log_Write_Rate_Thread_Dt(float dt, float dtAvg, float dtMax, float
 #endif
 }
 
+void Copter::Log_Write_Rate_Thread_Latency(uint32_t latency_avg_us, uint32_t latency_max_us, uint32_t batch_max)
+{
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    const log_Rate_Thread_Latency pkt {
+        LOG_PACKET_HEADER_INIT(LOG_RATE_THREAD_LATENCY_MSG),
+        time_us         : AP_HAL::micros64(),
+        latency_avg     : latency_avg_us,
+        latency_max     : latency_max_us,
+        batch_max       : uint8_t(batch_max)
+    };
+    logger.WriteBlock(&pkt, sizeof(pkt));
+#endif
+}
+
 // type and unit information can be found in
 // libraries/AP_Logger/Logstructure.h; search for "log_Units" for
 // units and "Format characters" for field type information
@@ -569,6 +592,16 @@ const struct LogStructure Copter::log_structure[] = {
     { LOG_RATE_THREAD_DT_MSG, sizeof(log_Rate_Thread_Dt),
       "RTDT", "Qffff", "TimeUS,dt,dtAvg,dtMax,dtMin", "sssss", "F----" , true },
 
+// @LoggerMessage: RTLT
+// @Description: Attitude controller gyro sample to motor output latency
+// @Field: TimeUS: Time since system startup
+// @Field: LatAvg: average time from gyro sample to motor output since last log output
+// @Field: LatMax: max time from gyro sample to motor output since last log output
+// @Field: BMax: max number of gyro samples processed together since last log output
+
+    { LOG_RATE_THREAD_LATENCY_MSG, sizeof(log_Rate_Thread_Latency),
+      "RTLT", "QIIB", "TimeUS,LatAvg,LatMax,BMax", "sss-", "FFF-" , true },
+
 };
 
 uint8_t Copter::get_num_log_structures() const
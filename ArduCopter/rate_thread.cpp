@@ -15,6 +15,7 @@
 #include "Copter.h"
 #include <AP_InertialSensor/AP_InertialSensor_rate_config.h>
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+#include <AP_InertialSensor/FastRateBuffer.h>
 
 #pragma GCC optimize("O2")
 
@@ -67,24 +68,26 @@
 
  Design:
 
- 1. Filtered gyro samples are (sub-sampled and) pushed into an ObjectBuffer from the INS backend.
+ 1. Filtered gyro samples are (sub-sampled and) pushed into a lock-free ring from the INS backend,
+    together with the time they were sampled.
  2. The pushed sample is published to the INS front-end so that the rest of the vehicle only
     sees published values that have been used by the rate controller. When the rate thread is not 
     in use the filtered samples are effectively sub-sampled at the main loop rate. The EKF is unaffected
     as it uses delta angles calculated from the raw gyro values. (It might be possible to avoid publishing
     from the rate thread by only updating _gyro_filtered when a value is pushed).
- 3. A notification is sent that a sample is available
- 4. The rate thread is blocked waiting for a sample. When it receives a notification it:
-    4a. Runs the rate controller
-    4b. Pushes the new pwm values. Periodically at the main loop rate all of the SRV_Channels::push()
+ 3. If the rate thread is waiting a notification is sent that a sample is available
+ 4. The rate thread is blocked waiting for a sample. When it receives a notification it takes all
+    of the available samples and:
+    4a. Runs the rate controller on each sample in turn
+    4b. Pushes the new pwm values once for the batch. Periodically at the main loop rate all of the SRV_Channels::push()
         functionality is run as well.
  5. The rcout dshot thread is blocked waiting for a new pwm value. When it is signalled by the
     rate thread it wakes up and runs the dshot motor output logic.
  6. Periodically the rate thread:
-    6a. Logs the rate outputs (1Khz)
+    6a. Logs the rate outputs (1Khz) and the sample to motor output latency (1Hz)
     6b. Updates the notch filter centers (Gyro rate/2)
-    6c. Checks the ObjectBuffer length and main loop delay (10Hz)
-        If the ObjectBuffer length has been longer than 2 for the last 5 cycles or the main loop has
+    6c. Checks the number of samples taken and main loop delay (10Hz)
+        If more than 2 samples have been waiting for the last 5 cycles or the main loop has
         been slowed down then the rate thread is slowed down by telling the INS to sub-sample. This
         mechanism is continued until the rate thread is able to keep up with the sub-sample rate.
         The inverse of this mechanism is run if the rate thread is able to keep up but is running slower
@@ -185,6 +188,11 @@ void Copter::rate_controller_thread()
     uint32_t last_rate_increase_ms = 0;
 #if HAL_LOGGING_ENABLED
     uint32_t last_rtdt_log_ms = now_ms;
+    uint32_t last_rtlt_log_ms = now_ms;
+    uint32_t latency_sum_us = 0;
+    uint32_t latency_max_us = 0;
+    uint32_t latency_count = 0;
+    uint32_t batch_max = 0;
 #endif
     uint32_t last_notch_sample_ms = now_ms;
     bool was_using_rate_thread = false;
@@ -231,9 +239,10 @@ void Copter::rate_controller_thread()
         }
         ins.set_rate_decimation(rate_decimation);
 
-        // wait for an IMU sample
-        Vector3f gyro;
-        if (!ins.get_next_gyro_sample(gyro)) {
+        // wait for IMU samples, taking all that are available
+        AP_InertialSensor::FastRateSample samples[AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE];
+        const uint8_t num_samples = ins.get_next_gyro_samples(samples, ARRAY_SIZE(samples));
+        if (num_samples == 0) {
             continue;   // go around again
         }
 
@@ -249,20 +258,24 @@ void Copter::rate_controller_thread()
         const float dt = dt_us * 1.0e-6;
         last_run_us = now_us;
 
-        // check if we are falling behind
-        if (ins.get_num_gyro_samples() > 2) {
+        // check if we are falling behind, more than 2 samples were
+        // waiting behind the first
+        if (num_samples > 3) {
             running_slow++;
         } else if (running_slow > 0) {
             running_slow--;
         }
         if (AP::scheduler().get_extra_loop_us() == 0) {
-            rate_loop_count++;
+            rate_loop_count += num_samples;
         }
 
         // run the rate controller on all available samples
         // it is important not to drop samples otherwise the filtering will be fubar
         // there is no need to output to the motors more than once for every batch of samples
-        attitude_control->rate_controller_run_dt(gyro + ahrs.get_gyro_drift(), sensor_dt);
+        const Vector3f &gyro_drift = ahrs.get_gyro_drift();
+        for (uint8_t i = 0; i < num_samples; i++) {
+            attitude_control->rate_controller_run_dt(samples[i].gyro + gyro_drift, sensor_dt);
+        }
 
 #ifdef RATE_LOOP_TIMING_DEBUG
         rate_controller_time_us += AP_HAL::micros() - rate_now_us;
@@ -275,6 +288,15 @@ void Copter::rate_controller_thread()
         }
         motors_output(main_loop_count == 0);
 
+#if HAL_LOGGING_ENABLED
+        // time from the newest sample to the motor output
+        const uint32_t latency_us = AP_HAL::micros() - samples[num_samples-1].sample_us;
+        latency_sum_us += latency_us;
+        latency_max_us = MAX(latency_max_us, latency_us);
+        latency_count++;
+        batch_max = MAX(batch_max, uint32_t(num_samples));
+#endif
+
         // process filter updates
         if (run_decimated_callback(rates.filter_rate, filter_loop_count)) {
             filter_loop_count = 0;
@@ -292,6 +314,14 @@ void Copter::rate_controller_thread()
             min_dt = sensor_dt;
             last_rtdt_log_ms = now_ms;
         }
+        if (now_ms - last_rtlt_log_ms >= 1000) {    // 1 Hz
+            Log_Write_Rate_Thread_Latency(latency_sum_us / MAX(latency_count, 1U), latency_max_us, batch_max);
+            latency_sum_us = 0;
+            latency_max_us = 0;
+            latency_count = 0;
+            batch_max = 0;
+            last_rtlt_log_ms = now_ms;
+        }
 #endif
 
 #ifdef RATE_LOOP_TIMING_DEBUG
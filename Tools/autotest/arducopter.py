@@ -6272,6 +6272,49 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         esc_hz = rpm_total / (rpm_count * 60)
         return esc_hz
 
+    def IMUBatchSamplingContinuous(self):
+        '''check continuous batch sampling logs every sample of every IMU'''
+        self.set_parameters({
+            "INS_LOG_BAT_MASK": 7,
+            "INS_LOG_BAT_OPT": 8,
+            "LOG_BITMASK": 958,
+            "LOG_DISARMED": 0,
+        })
+        self.reboot_sitl()
+
+        self.takeoff(10, mode="ALT_HOLD")
+        self.delay_sim_time(30)
+        self.do_RTL()
+
+        mlog = self.dfreader_for_current_onboard_log()
+        last_seqno = {}
+        blocks = {}
+        dropped = {}
+        while True:
+            m = mlog.recv_match(type=['ISCH', 'ISCD'])
+            if m is None:
+                break
+            key = (m.type, m.instance)
+            if m.get_type() == 'ISCH':
+                dropped[key] = m.drop
+                continue
+            if key in last_seqno and m.N != last_seqno[key] + 1:
+                raise NotAchievedException("Stream %s jumped from block %u to %u" % (str(key), last_seqno[key], m.N))
+            last_seqno[key] = m.N
+            blocks[key] = blocks.get(key, 0) + 1
+
+        if len(blocks) == 0:
+            raise NotAchievedException("No continuous batch sampling data logged")
+        for key in sorted(blocks.keys()):
+            if key not in dropped:
+                raise NotAchievedException("No ISCH for stream %s" % str(key))
+            if dropped[key] != 0:
+                raise NotAchievedException("Stream %s dropped %u samples" % (str(key), dropped[key]))
+            if (1 - key[0], key[1]) not in blocks:
+                raise NotAchievedException("Stream %s has no matching %s stream" %
+                                           (str(key), "gyro" if key[0] == 0 else "accel"))
+            self.progress("Stream %s logged %u samples" % (str(key), blocks[key] * 32))
+
     def DynamicNotches(self):
         """Use dynamic harmonic notch to control motor noise."""
         self.progress("Flying with dynamic notches")
@@ -13337,6 +13380,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         ret = ([
             self.MotorVibration,
             Test(self.DynamicNotches, attempts=4),
+            self.IMUBatchSamplingContinuous,
             self.PositionWhenGPSIsZero,
             self.DynamicRpmNotches, # Do not add attempts to this - failure is sign of a bug
             self.DynamicRpmNotchesRateThread,
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+
+'''
+Run a mission in SITL many times in parallel, sweeping parameter values
+over a grid or a random sample, and collect metrics from the onboard
+logs into a single table.
+
+Each sweep is given as NAME=MIN:MAX:STEPS for a linearly spaced range or
+NAME=V1,V2,... for explicit values, e.g.:
+
+  ./Tools/autotest/param_sweep.py build/sitl/bin/arducopter quad \
+      Tools/autotest/Generic_Missions/CMAC-copter-navtest.txt \
+      --sweep ATC_RAT_RLL_P=0.1:0.2:5 --sweep EK3_ACC_P_NSE=0.2,0.35,0.5 \
+      --workers 16 --output sweep.csv
+
+Each worker runs its own SITL instance (-I) in its own directory so
+workers do not share ports, eeprom or logs.
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import csv
+import itertools
+import math
+import multiprocessing
+import os
+import random
+import sys
+import time
+
+from pymavlink import DFReader
+
+from run_mission import RunMission
+from pysim import util
+
+
+class SweepRun(RunMission):
+    '''run a mission on a given SITL instance with a set of parameter overrides'''
+    def __init__(self, vehicle_binary, model, mission_filepath, instance, defaults_filepaths, speedup=None):
+        super(SweepRun, self).__init__(vehicle_binary, model, mission_filepath, speedup=speedup)
+        self.instance = instance
+        self.defaults_filepaths = defaults_filepaths
+
+    def adjust_ardupilot_port(self, port):
+        '''SITL shifts all its ports by 10 per instance'''
+        return port + 10 * self.instance
+
+    def sitl_rcin_port(self, offset=0):
+        return super(SweepRun, self).sitl_rcin_port(offset=offset) + 10 * self.instance
+
+    def start_SITL(self, **sitl_args):
+        sitl_args["customisations"] = ["-I", str(self.instance)]
+        sitl_args["defaults_filepath"] = self.model_defaults_filepath(self.model) + self.defaults_filepaths
+        super(SweepRun, self).start_SITL(**sitl_args)
+
+
+class LogMetrics(object):
+    '''accumulate metrics from an onboard log'''
+    def __init__(self, path):
+        self.path = path
+
+    def rms(self, values):
+        if len(values) == 0:
+            return None
+        return math.sqrt(sum([x*x for x in values]) / len(values))
+
+    def mean(self, values):
+        if len(values) == 0:
+            return None
+        return sum(values) / len(values)
+
+    def collect(self):
+        dfreader = DFReader.DFReader_binary(self.path, zero_time_base=True)
+        tracking_error = []
+        vel_innov = []
+        pos_innov = []
+        load = []
+        max_loop_time = 0
+        while True:
+            m = dfreader.recv_match(type=['PSCN', 'PSCE', 'NTUN', 'XKF3', 'PM'])
+            if m is None:
+                break
+            mtype = m.get_type()
+            if mtype in ('PSCN', 'PSCE'):
+                tracking_error.append(m.TPN - m.PN if mtype == 'PSCN' else m.TPE - m.PE)
+            elif mtype == 'NTUN':
+                # Plane logs XT, Rover logs XTrack
+                xt = getattr(m, 'XT', None)
+                if xt is None:
+                    xt = getattr(m, 'XTrack', None)
+                if xt is not None:
+                    tracking_error.append(xt)
+            elif mtype == 'XKF3':
+                if m.C != 0:
+                    # only the first core, which may not be the primary
+                    continue
+                vel_innov.extend([m.IVN, m.IVE, m.IVD])
+                pos_innov.extend([m.IPN, m.IPE, m.IPD])
+            elif mtype == 'PM':
+                # load is logged in tenths of a percent
+                load.append(m.Load * 0.1)
+                max_loop_time = max(max_loop_time, m.MaxT)
+
+        return {
+            "tracking_error_rms": self.rms(tracking_error),
+            "vel_innov_rms": self.rms(vel_innov),
+            "pos_innov_rms": self.rms(pos_innov),
+            "cpu_load_mean": self.mean(load),
+            "cpu_load_max": max(load) if len(load) else None,
+            "max_loop_time_us": max_loop_time,
+        }
+
+
+METRICS = [
+    "tracking_error_rms",
+    "vel_innov_rms",
+    "pos_innov_rms",
+    "cpu_load_mean",
+    "cpu_load_max",
+    "max_loop_time_us",
+]
+
+# per-worker state, set by worker_init
+worker_instance = None
+worker_dir = None
+
+
+def worker_init(instances, topdir):
+    '''give each worker process a SITL instance number and directory'''
+    global worker_instance
+    global worker_dir
+    worker_instance = instances.get()
+    worker_dir = os.path.join(topdir, "instance%u" % worker_instance)
+    os.makedirs(worker_dir, exist_ok=True)
+    os.chdir(worker_dir)
+
+
+def run_one(job):
+    '''run a single combination of parameters, returning a result row'''
+    (index, params, args) = job
+
+    param_filepath = os.path.join(worker_dir, "sweep-%u.parm" % index)
+    with open(param_filepath, "w") as f:
+        for (name, value) in params.items():
+            f.write("%s %s\n" % (name, str(value)))
+    defaults = [param_filepath]
+    if args.params is not None:
+        defaults = [args.params] + defaults
+
+    row = {"run": index}
+    row.update(params)
+    tstart = time.time()
+    x = None
+    try:
+        x = SweepRun(
+            args.vehicle_binary,
+            args.model,
+            args.mission_filepath,
+            worker_instance,
+            defaults,
+            speedup=args.speedup,
+        )
+        x.run()
+        logs = x.log_list()
+        if len(logs) == 0:
+            raise ValueError("no logs produced")
+        row.update(LogMetrics(logs[-1]).collect())
+        row["status"] = "ok"
+    except Exception as e:
+        row["status"] = "failed: %s" % str(e)
+    finally:
+        # a failed run leaves SITL running on this worker's instance
+        if x is not None and getattr(x, "sitl", None) is not None:
+            x.stop_SITL()
+    row["duration"] = round(time.time() - tstart, 1)
+    return row
+
+
+def parse_sweep(sweep):
+    '''parse NAME=MIN:MAX:STEPS or NAME=V1,V2,...'''
+    (name, spec) = sweep.split("=", 1)
+    if ":" in spec:
+        (low, high, steps) = spec.split(":")
+        (low, high, steps) = (float(low), float(high), int(steps))
+        if steps < 2:
+            return (name, [low])
+        return (name, [low + (high - low) * i / (steps - 1) for i in range(steps)])
+    return (name, [float(x) for x in spec.split(",")])
+
+
+def make_jobs(args):
+    '''work out the parameter combinations to run'''
+    sweeps = [parse_sweep(s) for s in args.sweep]
+    names = [s[0] for s in sweeps]
+    if args.random is not None:
+        # random sample, uniform over each range
+        rng = random.Random(args.seed)
+        combinations = []
+        for i in range(args.random):
+            combinations.append([rng.uniform(min(values), max(values)) for (_, values) in sweeps])
+    else:
+        combinations = itertools.product(*[values for (_, values) in sweeps])
+
+    jobs = []
+    for (index, values) in enumerate(combinations):
+        jobs.append((index, dict(zip(names, values)), args))
+    return (names, jobs)
+
+
+def main():
+    parser = argparse.ArgumentParser("param_sweep.py")
+    parser.add_argument('vehicle_binary', type=str, help='vehicle binary to use')
+    parser.add_argument('model', type=str, help='vehicle model to use')
+    parser.add_argument('mission_filepath', type=str, help='mission file path')
+    parser.add_argument('--params', type=str, default=None, help='base parameter file applied to every run')
+    parser.add_argument('--sweep', action='append', default=[], help='NAME=MIN:MAX:STEPS or NAME=V1,V2,...')
+    parser.add_argument('--random', type=int, default=None, help='run this many random samples instead of the full grid')
+    parser.add_argument('--seed', type=int, default=None, help='random seed for --random')
+    parser.add_argument('--workers', type=int, default=multiprocessing.cpu_count(), help='number of parallel SITL instances')
+    parser.add_argument('--speedup', type=int, default=None, help='simulation speedup')
+    parser.add_argument('--output', type=str, default="param_sweep.csv", help='CSV result file')
+    parser.add_argument('--sort', type=str, default="tracking_error_rms", choices=METRICS, help='metric to sort summary by')
+
+    args = parser.parse_args()
+    if len(args.sweep) == 0:
+        parser.error("at least one --sweep is required")
+
+    # workers run in their own directories
+    args.vehicle_binary = os.path.abspath(args.vehicle_binary)
+    args.mission_filepath = os.path.abspath(args.mission_filepath)
+    if args.params is not None:
+        args.params = os.path.abspath(args.params)
+
+    (names, jobs) = make_jobs(args)
+    workers = max(1, min(args.workers, len(jobs)))
+    print("Running %u runs on %u workers" % (len(jobs), workers))
+
+    topdir = util.reltopdir(os.path.join('tmp', 'param_sweep'))
+    instances = multiprocessing.Queue()
+    for i in range(workers):
+        instances.put(i)
+
+    results = []
+    pool = multiprocessing.Pool(workers, initializer=worker_init, initargs=(instances, topdir))
+    for row in pool.imap_unordered(run_one, jobs):
+        print("run %u: %s" % (row["run"], row["status"]))
+        results.append(row)
+    pool.close()
+    pool.join()
+
+    results.sort(key=lambda r: r["run"])
+    fieldnames = ["run"] + names + ["status", "duration"] + METRICS
+    with open(args.output, "w") as f:
+        writer = csv.DictWriter(f, fieldnames=fieldnames)
+        writer.writeheader()
+        for row in results:
+            writer.writerow(row)
+    print("Wrote %s" % args.output)
+
+    ok = [r for r in results if r["status"] == "ok" and r.get(args.sort) is not None]
+    ok.sort(key=lambda r: r[args.sort])
+    for row in ok[:10]:
+        print("%s=%.4f %s" % (args.sort, row[args.sort], " ".join(["%s=%s" % (n, row[n]) for n in names])))
+
+    return 0 if len(ok) == len(results) else 1
+
+
+if __name__ == "__main__":
+    os.environ['PYTHONUNBUFFERED'] = '1'
+
+    if sys.platform != "darwin":
+        os.putenv('TMPDIR', util.reltopdir('tmp'))
+
+    sys.exit(main())
@@ -0,0 +1,330 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  XRCE-DDS agent that exchanges packets with the AP_DDS client through
+  its shared memory region, so no socket or relay sits between them:
+
+    ros2 run ardupilot_dds_shm_agent shm_agent --domain-id 0
+
+  The region layout is documented in libraries/AP_DDS/AP_DDS_SHM.h and
+  the constants below must match it
+ */
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+#include <uxr/agent/transport/endpoint/CustomEndPoint.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t SHM_MAGIC = 0x53444441; // "ADDS"
+static const uint16_t SHM_VERSION = 1;
+static const uint32_t HEADER_LEN = 8;
+static const uint32_t RING_HEADER_LEN = 8;
+
+static_assert(sizeof(std::atomic<uint32_t>) == 4, "ring indexes must be plain 32 bit words");
+
+/*
+  one direction of the region. head and tail are free running byte
+  counts, only the producer writes head and only the consumer writes
+  tail. Each packet is prefixed by a little endian uint16_t length
+ */
+class Ring
+{
+public:
+    void attach(uint8_t *base, uint32_t ring_size)
+    {
+        head = reinterpret_cast<std::atomic<uint32_t> *>(base);
+        tail = reinterpret_cast<std::atomic<uint32_t> *>(base + 4);
+        data = base + RING_HEADER_LEN;
+        size = ring_size;
+    }
+
+    // queue a packet, false if there is not enough space for all of it
+    bool write(const uint8_t *buf, uint16_t len)
+    {
+        const uint32_t h = head->load(std::memory_order_relaxed);
+        const uint32_t t = tail->load(std::memory_order_acquire);
+        if (size - (h - t) < uint32_t(len) + 2U) {
+            return false;
+        }
+        const uint8_t hdr[2] { uint8_t(len & 0xFF), uint8_t(len >> 8) };
+        copy_in(h, hdr, sizeof(hdr));
+        copy_in(h + sizeof(hdr), buf, len);
+        head->store(h + sizeof(hdr) + len, std::memory_order_release);
+        return true;
+    }
+
+    // dequeue a packet, returning its length or 0 if the ring is
+    // empty. Packets larger than len are discarded
+    uint16_t read(uint8_t *buf, size_t len)
+    {
+        const uint32_t t = tail->load(std::memory_order_relaxed);
+        const uint32_t h = head->load(std::memory_order_acquire);
+        const uint32_t avail = h - t;
+        if (avail < 2) {
+            return 0;
+        }
+        uint8_t hdr[2];
+        copy_out(t, hdr, sizeof(hdr));
+        const uint16_t plen = hdr[0] | (uint16_t(hdr[1]) << 8);
+        if (avail < sizeof(hdr) + plen || avail > size) {
+            // corrupt ring, the client has restarted or misbehaved
+            tail->store(h, std::memory_order_release);
+            return 0;
+        }
+        const bool fits = plen <= len;
+        if (fits) {
+            copy_out(t + sizeof(hdr), buf, plen);
+        }
+        tail->store(t + sizeof(hdr) + plen, std::memory_order_release);
+        return fits ? plen : 0;
+    }
+
+private:
+    void copy_in(uint32_t ofs, const uint8_t *src, uint32_t n)
+    {
+        ofs &= (size-1);
+        const uint32_t n1 = std::min(n, size - ofs);
+        memcpy(&data[ofs], src, n1);
+        memcpy(&data[0], &src[n1], n - n1);
+    }
+
+    void copy_out(uint32_t ofs, uint8_t *dst, uint32_t n) const
+    {
+        ofs &= (size-1);
+        const uint32_t n1 = std::min(n, size - ofs);
+        memcpy(dst, &data[ofs], n1);
+        memcpy(&dst[n1], &data[0], n - n1);
+    }
+
+    std::atomic<uint32_t> *head;
+    std::atomic<uint32_t> *tail;
+    uint8_t *data;
+    uint32_t size;
+};
+
+/*
+  the client's region, mapped once it has been created
+ */
+class Region
+{
+public:
+    Region(int _domain_id, uint32_t _ring_size) :
+        domain_id(_domain_id),
+        ring_size(_ring_size)
+    {
+        snprintf(name, sizeof(name), "/ap_dds_%d", domain_id);
+    }
+
+    // map the region, waiting for the client to create it
+    bool attach(const std::atomic<bool> &stop)
+    {
+        const size_t region_len = HEADER_LEN + 2 * (RING_HEADER_LEN + ring_size);
+        printf("Waiting for %s\n", name);
+        while (!stop) {
+            const int fd = shm_open(name, O_RDWR, 0);
+            if (fd != -1) {
+                struct stat st;
+                if (fstat(fd, &st) == 0 && size_t(st.st_size) >= region_len) {
+                    void *p = mmap(nullptr, region_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    close(fd);
+                    if (p == MAP_FAILED) {
+                        perror("mmap");
+                        return false;
+                    }
+                    base = static_cast<uint8_t *>(p);
+                    len = region_len;
+                    magic = reinterpret_cast<std::atomic<uint32_t> *>(base);
+                    to_agent.attach(base + HEADER_LEN, ring_size);
+                    from_agent.attach(base + HEADER_LEN + RING_HEADER_LEN + ring_size, ring_size);
+                    return true;
+                }
+                close(fd);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return false;
+    }
+
+    void detach()
+    {
+        if (base != nullptr) {
+            munmap(base, len);
+            base = nullptr;
+        }
+    }
+
+    // true while the client has the rings set up
+    bool ready() const
+    {
+        if (magic->load(std::memory_order_acquire) != SHM_MAGIC) {
+            return false;
+        }
+        uint16_t version;
+        memcpy(&version, base + 4, sizeof(version));
+        return version == SHM_VERSION;
+    }
+
+    uint16_t mtu() const
+    {
+        uint16_t ret;
+        memcpy(&ret, base + 6, sizeof(ret));
+        return ret;
+    }
+
+    const int domain_id;
+    Ring to_agent;
+    Ring from_agent;
+
+private:
+    const uint32_t ring_size;
+    char name[32];
+    uint8_t *base = nullptr;
+    size_t len = 0;
+    std::atomic<uint32_t> *magic = nullptr;
+};
+
+static std::atomic<bool> stop_requested{false};
+
+static void handle_signal(int)
+{
+    stop_requested = true;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--domain-id N] [--ring-size BYTES] [--verbose LEVEL]\n", prog);
+    printf("  --domain-id    DDS_DOMAIN_ID of the client (default 0)\n");
+    printf("  --ring-size    AP_DDS_SHM_RING_SIZE of the client (default 131072)\n");
+    printf("  --verbose      agent log level 0 to 6 (default 4)\n");
+}
+
+int main(int argc, char **argv)
+{
+    int domain_id = 0;
+    uint32_t ring_size = 128*1024U;
+    uint8_t verbose = 4;
+    for (int i=1; i<argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--domain-id" && i+1 < argc) {
+            domain_id = atoi(argv[++i]);
+        } else if (arg == "--ring-size" && i+1 < argc) {
+            ring_size = strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--verbose" && i+1 < argc) {
+            verbose = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (ring_size == 0 || (ring_size & (ring_size-1)) != 0) {
+        fprintf(stderr, "ring size must be a power of 2\n");
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    Region region(domain_id, ring_size);
+
+    eprosima::uxr::CustomAgent::InitFunction init_function = [&]() -> bool {
+        if (!region.attach(stop_requested)) {
+            return false;
+        }
+        printf("Attached to domain %d, MTU %u\n", region.domain_id, unsigned(region.mtu()));
+        return true;
+    };
+
+    eprosima::uxr::CustomAgent::FiniFunction fini_function = [&]() -> bool {
+        region.detach();
+        return true;
+    };
+
+    eprosima::uxr::CustomAgent::RecvMsgFunction recv_msg_function = [&](
+            eprosima::uxr::CustomEndPoint *source_endpoint,
+            uint8_t *buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc &transport_rc) -> ssize_t {
+        // the ring has no wakeup, so poll it as the client does
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        do {
+            if (region.ready()) {
+                const uint16_t n = region.to_agent.read(buffer, buffer_length);
+                if (n > 0) {
+                    source_endpoint->set_member_value<uint32_t>("domain", uint32_t(region.domain_id));
+                    transport_rc = eprosima::uxr::TransportRc::ok;
+                    return n;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        } while (std::chrono::steady_clock::now() < deadline);
+        transport_rc = eprosima::uxr::TransportRc::timeout_error;
+        return 0;
+    };
+
+    eprosima::uxr::CustomAgent::SendMsgFunction send_msg_function = [&](
+            const eprosima::uxr::CustomEndPoint * /*destination_endpoint*/,
+            uint8_t *buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc &transport_rc) -> ssize_t {
+        if (!region.ready() || message_length > region.mtu() ||
+            !region.from_agent.write(buffer, uint16_t(message_length))) {
+            // client gone or not keeping up, XRCE reliability resends
+            transport_rc = eprosima::uxr::TransportRc::server_error;
+            return 0;
+        }
+        transport_rc = eprosima::uxr::TransportRc::ok;
+        return ssize_t(message_length);
+    };
+
+    eprosima::uxr::CustomEndPoint endpoint;
+    endpoint.add_member<uint32_t>("domain");
+
+    // the ring keeps packet boundaries, so no framing
+    eprosima::uxr::CustomAgent agent(
+        "AP_DDS_SHM",
+        &endpoint,
+        eprosima::uxr::Middleware::Kind::FASTDDS,
+        false,
+        init_function,
+        fini_function,
+        send_msg_function,
+        recv_msg_function);
+
+    agent.set_verbose_level(verbose);
+    if (!agent.start()) {
+        fprintf(stderr, "Failed to start agent\n");
+        return 1;
+    }
+    while (!stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    agent.stop();
+    return 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+'''
+ flood a socketcan interface with frames to load test SITL or Linux
+ CAN drivers. Each frame carries a 32 bit sequence number so a second
+ instance run with --receive can report dropped frames
+
+ example, saturating vcan0 while SITL is attached to it:
+   ./CAN_flood.py vcan0 --rate 8000
+   ./CAN_flood.py vcan0 --receive
+
+ CAN FD frames need the interface MTU set to 72, see can_sitl.sh
+'''
+
+import socket
+import struct
+import sys
+import time
+
+from argparse import ArgumentParser
+parser = ArgumentParser(description='CAN bus flood load test')
+parser.add_argument("iface", default=None, type=str, help="socketcan interface, e.g. vcan0")
+parser.add_argument("--rate", default=8000, type=float, help="frames per second, 0 for as fast as possible")
+parser.add_argument("--duration", default=0, type=float, help="seconds to run for, 0 for forever")
+parser.add_argument("--id", default=0x1FFFFF00, type=lambda x: int(x, 0), help="base CAN ID, extended")
+parser.add_argument("--num-ids", default=4, type=int, help="number of CAN IDs to cycle through")
+parser.add_argument("--len", default=8, type=int, help="payload length")
+parser.add_argument("--fd", action='store_true', help="send CAN FD frames")
+parser.add_argument("--receive", action='store_true', help="receive and count drops instead of sending")
+parser.add_argument("--report", default=1.0, type=float, help="report interval in seconds")
+
+args = parser.parse_args()
+
+CAN_FRAME_FMT = "=IB3x8s"
+CANFD_FRAME_FMT = "=IBB2x64s"
+CAN_MTU = struct.calcsize(CAN_FRAME_FMT)
+CANFD_MTU = struct.calcsize(CANFD_FRAME_FMT)
+CANFD_BRS = 0x01
+
+if args.len < 4 or args.len > (64 if args.fd else 8):
+    print("payload length must be 4 to %u" % (64 if args.fd else 8))
+    sys.exit(1)
+
+sock = socket.socket(socket.PF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+if args.fd or args.receive:
+    try:
+        sock.setsockopt(socket.SOL_CAN_RAW, socket.CAN_RAW_FD_FRAMES, 1)
+    except OSError:
+        if args.fd:
+            print("CAN FD not supported on %s" % args.iface)
+            sys.exit(1)
+sock.bind((args.iface,))
+
+
+def pack_frame(can_id, seq):
+    data = struct.pack("<I", seq) + bytes(args.len - 4)
+    can_id |= socket.CAN_EFF_FLAG
+    if args.fd:
+        return struct.pack(CANFD_FRAME_FMT, can_id, args.len, CANFD_BRS, data)
+    return struct.pack(CAN_FRAME_FMT, can_id, args.len, data)
+
+
+def run_sender():
+    seq = [0] * args.num_ids
+    sent = 0
+    blocked = 0
+    last_sent = 0
+    tstart = time.monotonic()
+    last_report = tstart
+    idx = 0
+    while True:
+        now = time.monotonic()
+        if args.duration > 0 and now - tstart > args.duration:
+            break
+        if args.rate > 0:
+            # send in bursts to catch up with the target rate
+            due = int((now - tstart) * args.rate) - sent
+            if due <= 0:
+                time.sleep(0.0002)
+                continue
+        else:
+            due = 64
+        for _ in range(due):
+            try:
+                sock.send(pack_frame(args.id + idx, seq[idx]))
+            except OSError:
+                # kernel queue full, the bus is saturated
+                blocked += 1
+                time.sleep(0.0001)
+                break
+            seq[idx] = (seq[idx] + 1) & 0xFFFFFFFF
+            idx = (idx + 1) % args.num_ids
+            sent += 1
+        if now - last_report >= args.report:
+            print("sent %u frames %.0f/s blocked %u" % (sent, (sent - last_sent) / (now - last_report), blocked))
+            last_sent = sent
+            last_report = now
+    print("sent %u frames in %.1fs" % (sent, time.monotonic() - tstart))
+
+
+def run_receiver():
+    expected = {}
+    received = 0
+    dropped = 0
+    last_received = 0
+    tstart = time.monotonic()
+    last_report = tstart
+    sock.settimeout(0.1)
+    while True:
+        now = time.monotonic()
+        if args.duration > 0 and now - tstart > args.duration:
+            break
+        if now - last_report >= args.report:
+            print("received %u frames %.0f/s dropped %u" % (received, (received - last_received) / (now - last_report), dropped))
+            last_received = received
+            last_report = now
+        try:
+            pkt = sock.recv(CANFD_MTU)
+        except socket.timeout:
+            continue
+        if len(pkt) == CANFD_MTU:
+            can_id, length, _, data = struct.unpack(CANFD_FRAME_FMT, pkt)
+        elif len(pkt) == CAN_MTU:
+            can_id, length, data = struct.unpack(CAN_FRAME_FMT, pkt)
+        else:
+            continue
+        can_id &= socket.CAN_EFF_MASK
+        if can_id < args.id or can_id >= args.id + args.num_ids or length < 4:
+            continue
+        seq, = struct.unpack("<I", data[:4])
+        if can_id in expected and seq != expected[can_id]:
+            dropped += (seq - expected[can_id]) & 0xFFFFFFFF
+        expected[can_id] = (seq + 1) & 0xFFFFFFFF
+        received += 1
+    print("received %u frames dropped %u" % (received, dropped))
+
+
+try:
+    if args.receive:
+        run_receiver()
+    else:
+        run_sender()
+except KeyboardInterrupt:
+    pass
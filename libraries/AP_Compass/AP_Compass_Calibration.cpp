@@ -11,6 +11,17 @@ const extern AP_HAL::HAL& hal;
 
 #if COMPASS_CAL_ENABLED
 
+/*
+  the deepest call on the compasscal thread is an ellipsoid fit step.
+  run_ellipsoid_fit() holds JTJ, its LM backup and two parameter sets
+  (~0.9k), calc_normal_equations() a Jacobian batch (~0.4k) and
+  calc_jacob_batch() its temporaries (~0.25k), as measured by
+  -fstack-usage. The rest covers the thread entry and text messages
+ */
+#ifndef AP_COMPASS_CAL_STACK_SIZE
+#define AP_COMPASS_CAL_STACK_SIZE 2560
+#endif
+
 void Compass::cal_update()
 {
     if (hal.util->get_soft_armed()) {
@@ -97,7 +108,7 @@ bool Compass::_start_calibration(uint8_t i, bool retry, float delay)
     }
     if (!_cal_thread_started) {
         _cal_requires_reboot = true;
-        if (!hal.scheduler->thread_create(FUNCTOR_BIND(this, &Compass::_update_calibration_trampoline, void), "compasscal", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND(this, &Compass::_update_calibration_trampoline, void), "compasscal", AP_COMPASS_CAL_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "CompassCalibrator: Cannot start compass thread.");
             return false;
         }
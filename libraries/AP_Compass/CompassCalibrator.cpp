@@ -595,6 +595,37 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     return sum;
 }
 
+/*
+  replace the sample buffer and reset the fit state, used by benchmarks
+ */
+bool CompassCalibrator::set_samples(const Vector3f *samples, uint16_t count)
+{
+    if (count > COMPASS_CAL_NUM_SAMPLES) {
+        return false;
+    }
+    if (_sample_buffer == nullptr) {
+        _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
+        if (_sample_buffer == nullptr) {
+            return false;
+        }
+    }
+    reset_state();
+    for (uint16_t i = 0; i < count; i++) {
+        _sample_buffer[i].set(samples[i]);
+    }
+    _samples_collected = count;
+    calc_initial_offset();
+    initialize_fit();
+    return true;
+}
+
+void CompassCalibrator::free_samples()
+{
+    free(_sample_buffer);
+    _sample_buffer = nullptr;
+    _samples_collected = 0;
+}
+
 // calculate initial offsets by simply taking the average values of the samples
 void CompassCalibrator::calc_initial_offset()
 {
@@ -606,28 +637,103 @@ void CompassCalibrator::calc_initial_offset()
     _params.offset /= _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+/*
+  calc the Jacobians and residuals of a batch of samples. The samples
+  are unpacked once and every term is computed in a loop over the
+  batch, so the residual and the soft iron product are shared between
+  the residual and all parameters
+ */
+void CompassCalibrator::calc_jacob_batch(uint16_t start, uint8_t count, const param_t& params, bool ellipsoid, JacobianBatch &batch) const
 {
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0: partial derivative (radius wrt fitness fn) fn operated on sample
-    ret[0] = 1.0f;
-    // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    // samples with offsets applied
+    float px[COMPASS_CAL_JACOB_BATCH];
+    float py[COMPASS_CAL_JACOB_BATCH];
+    float pz[COMPASS_CAL_JACOB_BATCH];
+    for (uint8_t k = 0; k < count; k++) {
+        const Vector3f sample = _sample_buffer[start+k].get();
+        px[k] = sample.x + offset.x;
+        py[k] = sample.y + offset.y;
+        pz[k] = sample.z + offset.z;
+    }
+
+    // offset Jacobians are the first three for an ellipsoid, after radius for a sphere
+    float *j_ofs_x = batch.jacob[ellipsoid ? 0 : 1];
+    float *j_ofs_y = batch.jacob[ellipsoid ? 1 : 2];
+    float *j_ofs_z = batch.jacob[ellipsoid ? 2 : 3];
+
+    for (uint8_t k = 0; k < count; k++) {
+        const float A = (diag.x    * px[k]) + (offdiag.x * py[k]) + (offdiag.y * pz[k]);
+        const float B = (offdiag.x * px[k]) + (diag.y    * py[k]) + (offdiag.z * pz[k]);
+        const float C = (offdiag.y * px[k]) + (offdiag.z * py[k]) + (diag.z    * pz[k]);
+        const float length = norm(A, B, C);
+
+        batch.resid[k] = params.radius - length;
+
+        // partial derivative (offsets wrt fitness fn) fn operated on sample
+        j_ofs_x[k] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
+        j_ofs_y[k] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
+        j_ofs_z[k] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+
+        if (!ellipsoid) {
+            // partial derivative (radius wrt fitness fn) fn operated on sample
+            batch.jacob[0][k] = 1.0f;
+            continue;
+        }
+        // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
+        batch.jacob[3][k] = -1.0f * (px[k] * A)/length;
+        batch.jacob[4][k] = -1.0f * (py[k] * B)/length;
+        batch.jacob[5][k] = -1.0f * (pz[k] * C)/length;
+        // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
+        batch.jacob[6][k] = -1.0f * ((py[k] * A) + (px[k] * B))/length;
+        batch.jacob[7][k] = -1.0f * ((pz[k] * A) + (px[k] * C))/length;
+        batch.jacob[8][k] = -1.0f * ((pz[k] * B) + (py[k] * C))/length;
+    }
+}
+
+/*
+  accumulate the Gauss-Newton normal equations over all samples
+  collected. JTJ and JTFI must be zeroed by the caller. JTJ is
+  symmetric so only the upper triangle is summed, and each element
+  sums the samples in order so results match a per-sample evaluation
+ */
+void CompassCalibrator::calc_normal_equations(const param_t& params, bool ellipsoid, float *JTJ, float *JTFI) const
+{
+    const uint8_t n = ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
+    JacobianBatch batch;
+
+    for (uint16_t start = 0; start < _samples_collected; start += COMPASS_CAL_JACOB_BATCH) {
+        const uint8_t count = MIN(_samples_collected - start, COMPASS_CAL_JACOB_BATCH);
+        calc_jacob_batch(start, count, params, ellipsoid, batch);
+
+        for (uint8_t i = 0; i < n; i++) {
+            const float *Ji = batch.jacob[i];
+            // compute JTJ
+            for (uint8_t j = i; j < n; j++) {
+                const float *Jj = batch.jacob[j];
+                float sum = JTJ[i*n+j];
+                for (uint8_t k = 0; k < count; k++) {
+                    sum += Ji[k] * Jj[k];
+                }
+                JTJ[i*n+j] = sum;
+            }
+            // compute JTFI
+            float sum = JTFI[i];
+            for (uint8_t k = 0; k < count; k++) {
+                sum += Ji[k] * batch.resid[k];
+            }
+            JTFI[i] = sum;
+        }
+    }
+
+    for (uint8_t i = 1; i < n; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*n+j] = JTJ[j*n+i];
+        }
+    }
 }
 
 // run sphere fit to calculate diagonals and offdiagonals
@@ -646,27 +752,12 @@ void CompassCalibrator::run_sphere_fit()
     fit1_params = fit2_params = _params;
 
     float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
+    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
     float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations(fit1_params, false, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    //a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -717,36 +808,6 @@ void CompassCalibrator::run_sphere_fit()
     }
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
-{
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
-    // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
-    // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
-}
-
 void CompassCalibrator::run_ellipsoid_fit()
 {
     if (_sample_buffer == nullptr) {
@@ -762,27 +823,12 @@ void CompassCalibrator::run_ellipsoid_fit()
     fit1_params = fit2_params = _params;
 
     float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
     float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations(fit1_params, true, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
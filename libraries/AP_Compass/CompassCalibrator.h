@@ -9,6 +9,7 @@
 #define COMPASS_CAL_NUM_SPHERE_PARAMS       4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS    9
 #define COMPASS_CAL_NUM_SAMPLES             300     // number of samples required before fitting begins
+#define COMPASS_CAL_JACOB_BATCH             8       // number of samples per batch of Jacobian evaluations
 
 class CompassCalibrator {
 public:
@@ -103,6 +104,19 @@ protected:
     // return true if this is a right angle rotation
     bool right_angle_rotation(Rotation r) const;
 
+    // replace the sample buffer with a set of samples and prepare for
+    // fitting, protected so benchmarks can drive the fits directly
+    bool set_samples(const Vector3f *samples, uint16_t count);
+
+    // free the sample buffer allocated by set_samples() or start()
+    void free_samples();
+
+    // run sphere fit to calculate diagonals and offdiagonals
+    void run_sphere_fit();
+
+    // run ellipsoid fit to calculate diagonals and offdiagonals
+    void run_ellipsoid_fit();
+
 private:
 
     // results
@@ -181,13 +195,19 @@ private:
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
-    // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_sphere_fit();
+    // Jacobians and residuals for a batch of samples, stored as one
+    // array per parameter so the accumulation loops run over
+    // contiguous memory. Sphere fits use the first four parameters
+    struct JacobianBatch {
+        float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS][COMPASS_CAL_JACOB_BATCH];
+        float resid[COMPASS_CAL_JACOB_BATCH];
+    };
 
-    // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_ellipsoid_fit();
+    // calc the sphere or ellipsoid Jacobians and residuals of count samples starting at start
+    void calc_jacob_batch(uint16_t start, uint8_t count, const param_t& params, bool ellipsoid, JacobianBatch &batch) const;
+
+    // accumulate JTJ and JTFI for a sphere or ellipsoid fit over all samples collected
+    void calc_normal_equations(const param_t& params, bool ellipsoid, float *JTJ, float *JTFI) const;
 
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
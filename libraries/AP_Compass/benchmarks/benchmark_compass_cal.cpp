@@ -0,0 +1,110 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Compass/CompassCalibrator.h>
+
+// Levenberg-Marquardt iterations of the compass calibration on a full sample buffer
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class CompassCalibratorBench : public CompassCalibrator {
+public:
+    ~CompassCalibratorBench() {
+        free_samples();
+    }
+
+    using CompassCalibrator::set_samples;
+    using CompassCalibrator::run_sphere_fit;
+    using CompassCalibrator::run_ellipsoid_fit;
+};
+
+static Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+
+/*
+  evenly spread directions on a sphere, distorted by soft and hard
+  iron errors and quantised as the calibrator stores them
+ */
+static void setup_samples()
+{
+    if (!samples[0].is_zero()) {
+        return;
+    }
+    const Matrix3f softiron {
+        1.08, 0.03, -0.02,
+        0.03, 0.95, 0.04,
+        -0.02, 0.04, 1.02
+    };
+    const Vector3f offset { 120, -80, 45 };
+    const float radius = 450;
+    for (uint16_t i=0; i<COMPASS_CAL_NUM_SAMPLES; i++) {
+        const float z = 1 - 2 * (i + 0.5) / COMPASS_CAL_NUM_SAMPLES;
+        const float r = safe_sqrt(1 - z*z);
+        const float theta = M_PI * (3 - safe_sqrt(5)) * i;
+        const Vector3f dir { r * cosf(theta), r * sinf(theta), z };
+        samples[i] = softiron * dir * radius + offset;
+    }
+}
+
+static CompassCalibratorBench *setup_calibrators(uint8_t count)
+{
+    setup_samples();
+    CompassCalibratorBench *cal = NEW_NOTHROW CompassCalibratorBench[count];
+    for (uint8_t i=0; i<count; i++) {
+        cal[i].set_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    }
+    return cal;
+}
+
+static void BM_CompassCalSphereFit(benchmark::State& state)
+{
+    CompassCalibratorBench *cal = setup_calibrators(1);
+    while (state.KeepRunning()) {
+        cal->run_sphere_fit();
+    }
+    delete[] cal;
+}
+
+static void BM_CompassCalEllipsoidFit(benchmark::State& state)
+{
+    CompassCalibratorBench *cal = setup_calibrators(1);
+    while (state.KeepRunning()) {
+        cal->run_ellipsoid_fit();
+    }
+    delete[] cal;
+}
+
+/*
+  all the fit steps of a calibration, as run by update() once the
+  buffer is full, for range(0) compasses
+ */
+static void BM_CompassCalAllSteps(benchmark::State& state)
+{
+    const uint8_t count = state.range(0);
+    CompassCalibratorBench *cal = setup_calibrators(count);
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        for (uint8_t i=0; i<count; i++) {
+            cal[i].set_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+        }
+        state.ResumeTiming();
+        for (uint8_t i=0; i<count; i++) {
+            // step one
+            for (uint8_t s=0; s<10; s++) {
+                cal[i].run_sphere_fit();
+            }
+            // step two
+            for (uint8_t s=0; s<15; s++) {
+                cal[i].run_sphere_fit();
+            }
+            for (uint8_t s=15; s<35; s++) {
+                cal[i].run_ellipsoid_fit();
+            }
+        }
+    }
+    delete[] cal;
+}
+
+BENCHMARK(BM_CompassCalSphereFit);
+BENCHMARK(BM_CompassCalEllipsoidFit);
+BENCHMARK(BM_CompassCalAllSteps)->DenseRange(1, 3);
+
+BENCHMARK_MAIN();
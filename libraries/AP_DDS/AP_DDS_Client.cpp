@@ -11,6 +11,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Logger/AP_Logger.h>
 #include <AP_BattMonitor/AP_BattMonitor.h>
 #include <AP_AHRS/AP_AHRS.h>
 #if AP_DDS_ARM_SERVER_ENABLED
@@ -45,42 +46,14 @@
 
 #define STRCPY(D,S) strncpy(D, S, ARRAY_SIZE(D))
 
+#ifdef UXR_CONFIG_CUSTOM_TRANSPORT_MTU
+static_assert(UXR_CONFIG_CUSTOM_TRANSPORT_MTU == AP_DDS_CUSTOM_TRANSPORT_MTU, "AP_DDS_CUSTOM_TRANSPORT_MTU does not match the MTU given to gen_config_h.py");
+static_assert(DDS_MTU <= AP_DDS_CUSTOM_TRANSPORT_MTU, "DDS_MTU is larger than the custom transport buffers");
+#endif
+
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-#if AP_DDS_TIME_PUB_ENABLED
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = AP_DDS_DELAY_TIME_TOPIC_MS;
-#endif // AP_DDS_TIME_PUB_ENABLED
-#if AP_DDS_BATTERY_STATE_PUB_ENABLED
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS;
-#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
-#if AP_DDS_IMU_PUB_ENABLED
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = AP_DDS_DELAY_IMU_TOPIC_MS;
-#endif // AP_DDS_IMU_PUB_ENABLED
-#if AP_DDS_LOCAL_POSE_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS;
-#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
-#if AP_DDS_LOCAL_VEL_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS;
-#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
-#if AP_DDS_AIRSPEED_PUB_ENABLED
-static constexpr uint16_t DELAY_AIRSPEED_TOPIC_MS = AP_DDS_DELAY_AIRSPEED_TOPIC_MS;
-#endif // AP_DDS_AIRSPEED_PUB_ENABLED
-#if AP_DDS_GEOPOSE_PUB_ENABLED
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = AP_DDS_DELAY_GEO_POSE_TOPIC_MS;
-#endif // AP_DDS_GEOPOSE_PUB_ENABLED
-#if AP_DDS_GOAL_PUB_ENABLED
-static constexpr uint16_t DELAY_GOAL_TOPIC_MS = AP_DDS_DELAY_GOAL_TOPIC_MS ;
-#endif // AP_DDS_GOAL_PUB_ENABLED
-#if AP_DDS_CLOCK_PUB_ENABLED
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS =AP_DDS_DELAY_CLOCK_TOPIC_MS;
-#endif // AP_DDS_CLOCK_PUB_ENABLED
-#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS;
-#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 static constexpr uint16_t DELAY_PING_MS = 500;
-#if AP_DDS_STATUS_PUB_ENABLED
-static constexpr uint16_t DELAY_STATUS_TOPIC_MS = AP_DDS_DELAY_STATUS_TOPIC_MS;
-#endif // AP_DDS_STATUS_PUB_ENABLED
 
 // Define the subscriber data members, which are static class scope.
 // If these are created on the stack in the subscriber,
@@ -161,9 +134,203 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
     // @User: Standard
     AP_GROUPINFO("_MAX_RETRY", 6, AP_DDS_Client, ping_max_retry, 10),
 
+#if AP_DDS_SHM_ENABLED
+    // @Param: _SHM_ENABLE
+    // @DisplayName: DDS shared memory enable
+    // @Description: Use a shared memory region to talk to an agent on the same computer instead of UDP. The region is named /ap_dds_<DDS_DOMAIN_ID> and needs an agent that supports it, such as the ardupilot_dds_shm_agent ROS 2 package. Only one vehicle can use each domain. Serial is still used if a serial port is configured for DDS.
+    // @Values: 0:Disabled,1:Enabled
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("_SHM_ENABLE", 7, AP_DDS_Client, shm.enable, 0),
+#endif
+
+    // @Param: _BW_LIMIT
+    // @DisplayName: DDS bandwidth limit
+    // @Description: Maximum rate at which the periodic topics are queued for the agent. When the limit is reached, topics are skipped lowest priority first: battery state, status, GPS global origin, goal, airspeed, geopose, NavSatFix, clock, time, local velocity, local pose and then IMU. Set to 0 for no limit.
+    // @Units: B/s
+    // @Range: 0 1000000
+    // @Increment: 100
+    // @User: Advanced
+    AP_GROUPINFO("_BW_LIMIT", 8, AP_DDS_Client, bw_limit, 0),
+
+#if AP_DDS_TIME_PUB_ENABLED
+    // @Param: _R_TIME
+    // @DisplayName: DDS time topic rate
+    // @Description: Rate at which the time is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_TIME", 9, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::TIME)], 1000 / AP_DDS_DELAY_TIME_TOPIC_MS),
+#endif
+
+#if AP_DDS_NAVSATFIX_PUB_ENABLED
+    // @Param: _R_NAVSAT
+    // @DisplayName: DDS NavSatFix check rate
+    // @Description: Rate at which the GPS receivers are checked for a new fix to publish. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_NAVSAT", 10, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::NAV_SAT_FIX)], 1000 / AP_DDS_DELAY_NAVSATFIX_TOPIC_MS),
+#endif
+
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    // @Param: _R_BATT
+    // @DisplayName: DDS battery state topic rate
+    // @Description: Rate at which the battery state is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_BATT", 11, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::BATTERY_STATE)], 1000 / AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS),
+#endif
+
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    // @Param: _R_LPOSE
+    // @DisplayName: DDS local pose topic rate
+    // @Description: Rate at which the local pose is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_LPOSE", 12, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::LOCAL_POSE)], 1000 / AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS),
+#endif
+
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    // @Param: _R_LVEL
+    // @DisplayName: DDS local velocity topic rate
+    // @Description: Rate at which the local velocity is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_LVEL", 13, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::LOCAL_VELOCITY)], 1000 / AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS),
+#endif
+
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    // @Param: _R_ASPD
+    // @DisplayName: DDS airspeed topic rate
+    // @Description: Rate at which the airspeed is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_ASPD", 14, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::AIRSPEED)], 1000 / AP_DDS_DELAY_AIRSPEED_TOPIC_MS),
+#endif
+
+#if AP_DDS_IMU_PUB_ENABLED
+    // @Param: _R_IMU
+    // @DisplayName: DDS IMU topic rate
+    // @Description: Rate at which sensor_msgs/Imu is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_IMU", 15, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::IMU)], 1000 / AP_DDS_DELAY_IMU_TOPIC_MS),
+#endif
+
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    // @Param: _R_GPOSE
+    // @DisplayName: DDS geopose topic rate
+    // @Description: Rate at which the geopose is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_GPOSE", 16, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::GEO_POSE)], 1000 / AP_DDS_DELAY_GEO_POSE_TOPIC_MS),
+#endif
+
+#if AP_DDS_CLOCK_PUB_ENABLED
+    // @Param: _R_CLOCK
+    // @DisplayName: DDS clock topic rate
+    // @Description: Rate at which the clock is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_CLOCK", 17, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::CLOCK)], 1000 / AP_DDS_DELAY_CLOCK_TOPIC_MS),
+#endif
+
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    // @Param: _R_ORIGIN
+    // @DisplayName: DDS GPS global origin topic rate
+    // @Description: Rate at which the GPS global origin is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_ORIGIN", 18, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::GPS_GLOBAL_ORIGIN)], 1000 / AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS),
+#endif
+
+#if AP_DDS_GOAL_PUB_ENABLED
+    // @Param: _R_GOAL
+    // @DisplayName: DDS goal topic rate
+    // @Description: Rate at which the goal is checked for changes to publish. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_GOAL", 19, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::GOAL)], 1000 / AP_DDS_DELAY_GOAL_TOPIC_MS),
+#endif
+
+#if AP_DDS_STATUS_PUB_ENABLED
+    // @Param: _R_STATUS
+    // @DisplayName: DDS status topic rate
+    // @Description: Rate at which the status is checked for changes to publish. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 400
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_R_STATUS", 20, AP_DDS_Client, pub_rate_hz[uint8_t(PubId::STATUS)], 1000 / AP_DDS_DELAY_STATUS_TOPIC_MS),
+#endif
+
     AP_GROUPEND
 };
 
+/*
+  periodic publishers in priority order. When DDS_BW_LIMIT is reached
+  the entries at the end of the table are skipped first
+ */
+const AP_DDS_Client::Publisher AP_DDS_Client::publishers[] {
+#if AP_DDS_IMU_PUB_ENABLED
+    { PubId::IMU, "IMU" },
+#endif
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    { PubId::LOCAL_POSE, "LPOS" },
+#endif
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    { PubId::LOCAL_VELOCITY, "LVEL" },
+#endif
+#if AP_DDS_TIME_PUB_ENABLED
+    { PubId::TIME, "TIME" },
+#endif
+#if AP_DDS_CLOCK_PUB_ENABLED
+    { PubId::CLOCK, "CLK" },
+#endif
+#if AP_DDS_NAVSATFIX_PUB_ENABLED
+    { PubId::NAV_SAT_FIX, "NSF" },
+#endif
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    { PubId::GEO_POSE, "GPOS" },
+#endif
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    { PubId::AIRSPEED, "ASPD" },
+#endif
+#if AP_DDS_GOAL_PUB_ENABLED
+    { PubId::GOAL, "GOAL" },
+#endif
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    { PubId::GPS_GLOBAL_ORIGIN, "ORGN" },
+#endif
+#if AP_DDS_STATUS_PUB_ENABLED
+    { PubId::STATUS, "STAT" },
+#endif
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    { PubId::BATTERY_STATE, "BATT" },
+#endif
+};
+
 #if AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_LOCAL_POSE_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED | AP_DDS_IMU_PUB_ENABLED
 static void initialize(geometry_msgs_msg_Quaternion& q)
 {
@@ -179,6 +346,10 @@ AP_DDS_Client::~AP_DDS_Client()
     // close transport
     if (is_using_serial) {
         uxr_close_custom_transport(&serial.transport);
+#if AP_DDS_SHM_ENABLED
+    } else if (is_using_shm) {
+        uxr_close_custom_transport(&shm.transport);
+#endif
     } else {
 #if AP_DDS_UDP_ENABLED
         uxr_close_custom_transport(&udp.transport);
@@ -1268,6 +1439,14 @@ bool AP_DDS_Client::init_transport()
     bool initTransportStatus = ddsSerialInit();
     is_using_serial = initTransportStatus;
 
+#if AP_DDS_SHM_ENABLED
+    // shared memory is only used if enabled, so takes priority over UDP
+    if (!initTransportStatus) {
+        initTransportStatus = ddsShmInit();
+        is_using_shm = initTransportStatus;
+    }
+#endif
+
 #if AP_DDS_UDP_ENABLED
     // fallback to UDP if available
     if (!initTransportStatus) {
@@ -1299,16 +1478,17 @@ bool AP_DDS_Client::init_session()
         hal.scheduler->delay(1000);
     }
 
-    // setup reliable stream buffers
-    input_reliable_stream = NEW_NOTHROW uint8_t[DDS_BUFFER_SIZE];
-    output_reliable_stream = NEW_NOTHROW uint8_t[DDS_BUFFER_SIZE];
+    // setup reliable stream buffers, one MTU of the transport per slot
+    const uint16_t stream_size = comm->mtu * DDS_STREAM_HISTORY;
+    input_reliable_stream = NEW_NOTHROW uint8_t[stream_size];
+    output_reliable_stream = NEW_NOTHROW uint8_t[stream_size];
     if (input_reliable_stream == nullptr || output_reliable_stream == nullptr) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "%s Allocation failed", msg_prefix);
         return false;
     }
 
-    reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
-    reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
+    reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream, stream_size, DDS_STREAM_HISTORY);
+    reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream, stream_size, DDS_STREAM_HISTORY);
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "%s Init complete", msg_prefix);
 
@@ -1458,7 +1638,7 @@ void AP_DDS_Client::write_time_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = builtin_interfaces_msg_Time_size_of_topic(&time_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, ub, topic_size);
         const bool success = builtin_interfaces_msg_Time_serialize_topic(&ub, &time_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1474,7 +1654,7 @@ void AP_DDS_Client::write_nav_sat_fix_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_NavSatFix_size_of_topic(&nav_sat_fix_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, ub, topic_size);
         const bool success = sensor_msgs_msg_NavSatFix_serialize_topic(&ub, &nav_sat_fix_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1491,7 +1671,7 @@ void AP_DDS_Client::write_static_transforms()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = tf2_msgs_msg_TFMessage_size_of_topic(&tx_static_transforms_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, ub, topic_size);
         const bool success = tf2_msgs_msg_TFMessage_serialize_topic(&ub, &tx_static_transforms_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1508,7 +1688,7 @@ void AP_DDS_Client::write_battery_state_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_BatteryState_size_of_topic(&battery_state_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, ub, topic_size);
         const bool success = sensor_msgs_msg_BatteryState_serialize_topic(&ub, &battery_state_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1525,7 +1705,7 @@ void AP_DDS_Client::write_local_pose_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&local_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, ub, topic_size);
         const bool success = geometry_msgs_msg_PoseStamped_serialize_topic(&ub, &local_pose_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1542,7 +1722,7 @@ void AP_DDS_Client::write_tx_local_velocity_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_TwistStamped_size_of_topic(&tx_local_velocity_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, ub, topic_size);
         const bool success = geometry_msgs_msg_TwistStamped_serialize_topic(&ub, &tx_local_velocity_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1558,7 +1738,7 @@ void AP_DDS_Client::write_tx_local_airspeed_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_Vector3Stamped_size_of_topic(&tx_local_airspeed_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB)].dw_id, ub, topic_size);
         const bool success = geometry_msgs_msg_Vector3Stamped_serialize_topic(&ub, &tx_local_airspeed_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1574,7 +1754,7 @@ void AP_DDS_Client::write_imu_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_Imu_size_of_topic(&imu_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, ub, topic_size);
         const bool success = sensor_msgs_msg_Imu_serialize_topic(&ub, &imu_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1591,7 +1771,7 @@ void AP_DDS_Client::write_geo_pose_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPoseStamped_size_of_topic(&geo_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, ub, topic_size);
         const bool success = geographic_msgs_msg_GeoPoseStamped_serialize_topic(&ub, &geo_pose_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1608,7 +1788,7 @@ void AP_DDS_Client::write_clock_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = rosgraph_msgs_msg_Clock_size_of_topic(&clock_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, ub, topic_size);
         const bool success = rosgraph_msgs_msg_Clock_serialize_topic(&ub, &clock_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1625,7 +1805,7 @@ void AP_DDS_Client::write_gps_global_origin_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&gps_global_origin_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, ub, topic_size);
         const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &gps_global_origin_topic);
         if (!success) {
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1641,7 +1821,7 @@ void AP_DDS_Client::write_goal_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&goal_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GOAL_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::GOAL_PUB)].dw_id, ub, topic_size);
         const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &goal_topic);
         if (!success) {
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1657,7 +1837,7 @@ void AP_DDS_Client::write_status_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = ardupilot_msgs_msg_Status_size_of_topic(&status_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATUS_PUB)].dw_id, &ub, topic_size);
+        prepare_output_stream(topics[to_underlying(TopicIndex::STATUS_PUB)].dw_id, ub, topic_size);
         const bool success = ardupilot_msgs_msg_Status_serialize_topic(&ub, &status_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1667,106 +1847,228 @@ void AP_DDS_Client::write_status_topic()
 }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
-void AP_DDS_Client::update()
+/*
+  gather the latest data for a topic and queue it on the output stream
+ */
+void AP_DDS_Client::publish(PubId id)
 {
-    WITH_SEMAPHORE(csem);
-    const auto cur_time_ms = AP_HAL::millis64();
-
+    switch (id) {
 #if AP_DDS_TIME_PUB_ENABLED
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    case PubId::TIME:
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
         write_time_topic();
-    }
+        break;
 #endif // AP_DDS_TIME_PUB_ENABLED
 #if AP_DDS_NAVSATFIX_PUB_ENABLED
-    for (uint8_t gps_instance = 0; gps_instance < GPS_MAX_INSTANCES; gps_instance++) {
-        if (update_topic(nav_sat_fix_topic, gps_instance)) {
-            write_nav_sat_fix_topic();
+    case PubId::NAV_SAT_FIX:
+        for (uint8_t gps_instance = 0; gps_instance < GPS_MAX_INSTANCES; gps_instance++) {
+            if (update_topic(nav_sat_fix_topic, gps_instance)) {
+                write_nav_sat_fix_topic();
+            }
         }
-    }
+        break;
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
+    case PubId::BATTERY_STATE:
         for (uint8_t battery_instance = 0; battery_instance < AP_BATT_MONITOR_MAX_INSTANCES; battery_instance++) {
             update_topic(battery_state_topic, battery_instance);
             if (battery_state_topic.present) {
                 write_battery_state_topic();
             }
         }
-        last_battery_state_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
+    case PubId::LOCAL_POSE:
         update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
         write_local_pose_topic();
-    }
+        break;
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
+    case PubId::LOCAL_VELOCITY:
         update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
         write_tx_local_velocity_topic();
-    }
+        break;
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 #if AP_DDS_AIRSPEED_PUB_ENABLED
-    if (cur_time_ms - last_airspeed_time_ms > DELAY_AIRSPEED_TOPIC_MS) {
-        last_airspeed_time_ms = cur_time_ms;
+    case PubId::AIRSPEED:
         if (update_topic(tx_local_airspeed_topic)) {
             write_tx_local_airspeed_topic();
         }
-    }
+        break;
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
+    case PubId::IMU:
         update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
         write_imu_topic();
-    }
+        break;
 #endif // AP_DDS_IMU_PUB_ENABLED
 #if AP_DDS_GEOPOSE_PUB_ENABLED
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
+    case PubId::GEO_POSE:
         update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
         write_geo_pose_topic();
-    }
+        break;
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 #if AP_DDS_CLOCK_PUB_ENABLED
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
+    case PubId::CLOCK:
         update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
         write_clock_topic();
-    }
+        break;
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
+    case PubId::GPS_GLOBAL_ORIGIN:
         update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
         write_gps_global_origin_topic();
-    }
+        break;
 #endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 #if AP_DDS_GOAL_PUB_ENABLED
-    if (cur_time_ms - last_goal_time_ms > DELAY_GOAL_TOPIC_MS) {
+    case PubId::GOAL:
         if (update_topic_goal(goal_topic)) {
             write_goal_topic();
         }
-        last_goal_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_GOAL_PUB_ENABLED
 #if AP_DDS_STATUS_PUB_ENABLED
-    if (cur_time_ms - last_status_check_time_ms > DELAY_STATUS_TOPIC_MS) {
+    case PubId::STATUS:
         if (update_topic(status_topic)) {
             write_status_topic();
         }
-        last_status_check_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_STATUS_PUB_ENABLED
+    default:
+        break;
+    }
+}
+
+/*
+  reserve space for a topic on the reliable output stream, recording the
+  bytes queued for the publisher statistics
+ */
+bool AP_DDS_Client::prepare_output_stream(const uxrObjectId &dw_id, ucdrBuffer &ub, uint32_t topic_size)
+{
+    if (uxr_prepare_output_stream(&session, reliable_out, dw_id, &ub, topic_size) == UXR_INVALID_REQUEST_ID) {
+        // the stream history is full of unacknowledged data
+        sched.stream_full = true;
+        return false;
+    }
+    sched.bytes_queued += topic_size;
+    return true;
+}
+
+void AP_DDS_Client::update()
+{
+    WITH_SEMAPHORE(csem);
+    const uint64_t now_us = AP_HAL::micros64();
+
+    // refill the bandwidth budget, allowing bursts of up to 100ms
+    const int32_t limit = bw_limit.get();
+    if (limit > 0) {
+        const float burst = MAX(limit * 0.1f, float(DDS_MTU));
+        sched.tokens = MIN(sched.tokens + (now_us - sched.last_refill_us) * 1.0e-6f * limit, burst);
+    }
+    sched.last_refill_us = now_us;
+
+    for (const auto &pub : publishers) {
+        const uint8_t i = uint8_t(pub.id);
+        const int16_t rate_hz = pub_rate_hz[i].get();
+        PublisherState &state = pub_state[i];
+        if (rate_hz <= 0 || now_us < state.next_due_us) {
+            continue;
+        }
+
+        // keep to the requested rate, but don't try to catch up on
+        // slots missed while the thread was delayed
+        const uint32_t period_us = 1000000UL / uint32_t(rate_hz);
+        state.next_due_us += period_us;
+        if (state.next_due_us <= now_us) {
+            state.next_due_us = now_us + period_us;
+        }
+
+        // over budget, skip this slot. Higher priority topics have
+        // already taken their share so the lowest are demoted first
+        if (limit > 0 && sched.tokens < state.last_bytes) {
+            state.deferred++;
+            continue;
+        }
+
+        sched.bytes_queued = 0;
+        sched.stream_full = false;
+        const uint32_t tstart_us = AP_HAL::micros();
+        publish(pub.id);
+        const uint32_t dt_us = AP_HAL::micros() - tstart_us;
+
+        if (sched.stream_full) {
+            state.drops++;
+        }
+        if (sched.bytes_queued == 0) {
+            // nothing new to send
+            continue;
+        }
+        state.count++;
+        state.bytes += sched.bytes_queued;
+        state.last_bytes = uint16_t(MIN(sched.bytes_queued, UINT16_MAX));
+        state.time_us_total += dt_us;
+        state.time_us_max = MAX(state.time_us_max, uint16_t(MIN(dt_us, UINT16_MAX)));
+        if (limit > 0) {
+            sched.tokens -= sched.bytes_queued;
+        }
+    }
+
+    if (now_us - sched.window_start_us >= 1000000U) {
+        write_publisher_stats(now_us);
+    }
 
     status_ok = uxr_run_session_time(&session, 1);
 }
 
+/*
+  log the publisher statistics for the last window and start a new one
+ */
+void AP_DDS_Client::write_publisher_stats(uint64_t now_us)
+{
+#if HAL_LOGGING_ENABLED
+    const float window_s = (now_us - sched.window_start_us) * 1.0e-6f;
+    if (sched.window_start_us != 0) {
+        for (const auto &pub : publishers) {
+            const PublisherState &state = pub_state[uint8_t(pub.id)];
+            if (pub_rate_hz[uint8_t(pub.id)].get() <= 0) {
+                continue;
+            }
+// @LoggerMessage: DDSP
+// @Description: DDS topic publisher statistics
+// @Field: TimeUS: Time since system startup
+// @Field: Name: topic publisher
+// @Field: Rate: rate at which the topic was queued
+// @Field: BPS: bytes queued per second
+// @Field: Drop: writes dropped because the output stream was full
+// @Field: Def: publishes skipped to stay within DDS_BW_LIMIT
+// @Field: TAvg: average time to gather and serialize the topic
+// @Field: TMax: maximum time to gather and serialize the topic
+            AP::logger().WriteStreaming("DDSP", "TimeUS,Name,Rate,BPS,Drop,Def,TAvg,TMax",
+                                        "s-zB--ss", "F-00--FF", "QnfIHHHH",
+                                        now_us,
+                                        pub.name,
+                                        state.count / window_s,
+                                        uint32_t(state.bytes / window_s),
+                                        state.drops,
+                                        state.deferred,
+                                        uint16_t(state.count > 0 ? state.time_us_total / state.count : 0),
+                                        state.time_us_max);
+        }
+    }
+#endif // HAL_LOGGING_ENABLED
+
+    for (auto &state : pub_state) {
+        state.count = 0;
+        state.drops = 0;
+        state.deferred = 0;
+        state.time_us_max = 0;
+        state.time_us_total = 0;
+        state.bytes = 0;
+    }
+    sched.window_start_us = now_us;
+}
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
 extern "C" {
     int clock_gettime(clockid_t clockid, struct timespec *ts);
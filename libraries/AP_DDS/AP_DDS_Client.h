@@ -69,17 +69,21 @@
 
 #define DDS_MTU             512
 #define DDS_STREAM_HISTORY  8
-#define DDS_BUFFER_SIZE     DDS_MTU * DDS_STREAM_HISTORY
 
 #if AP_DDS_UDP_ENABLED
 #include <AP_HAL/utility/Socket.h>
 #include <AP_Networking/AP_Networking_address.h>
 #endif
 
+#if AP_DDS_SHM_ENABLED
+#include "AP_DDS_SHM.h"
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 class AP_DDS_Client
 {
+    friend class AP_DDS_Client_Benchmark;
 
 private:
 
@@ -88,6 +92,7 @@ private:
     // Serial Allocation
     uxrSession session; //Session
     bool is_using_serial; // true when using serial transport
+    bool is_using_shm; // true when using shared memory transport
 
     // input and output stream
     uint8_t *input_reliable_stream;
@@ -99,8 +104,6 @@ private:
 
 #if AP_DDS_TIME_PUB_ENABLED
     builtin_interfaces_msg_Time time_topic;
-    // The last ms timestamp AP_DDS wrote a Time message
-    uint64_t last_time_time_ms;
     //! @brief Serialize the current time state and publish to the IO stream(s)
     void write_time_topic();
     static void update_topic(builtin_interfaces_msg_Time& msg);
@@ -108,8 +111,6 @@ private:
 
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
     geographic_msgs_msg_GeoPointStamped gps_global_origin_topic;
-    // The last ms timestamp AP_DDS wrote a gps global origin message
-    uint64_t last_gps_global_origin_time_ms;
     //! @brief Serialize the current gps global origin and publish to the IO stream(s)
     void write_gps_global_origin_topic();
     static void update_topic(geographic_msgs_msg_GeoPointStamped& msg);
@@ -117,8 +118,6 @@ private:
 
 #if AP_DDS_GOAL_PUB_ENABLED
     geographic_msgs_msg_GeoPointStamped goal_topic;
-    // The last ms timestamp AP_DDS wrote a goal message
-    uint64_t last_goal_time_ms;
     //! @brief Serialize the current goal and publish to the IO stream(s)
     void write_goal_topic();
     bool update_topic_goal(geographic_msgs_msg_GeoPointStamped& msg);
@@ -127,8 +126,6 @@ private:
 
 #if AP_DDS_GEOPOSE_PUB_ENABLED
     geographic_msgs_msg_GeoPoseStamped geo_pose_topic;
-    // The last ms timestamp AP_DDS wrote a GeoPose message
-    uint64_t last_geo_pose_time_ms;
     //! @brief Serialize the current geo_pose and publish to the IO stream(s)
     void write_geo_pose_topic();
     static void update_topic(geographic_msgs_msg_GeoPoseStamped& msg);
@@ -136,8 +133,6 @@ private:
 
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
     geometry_msgs_msg_PoseStamped local_pose_topic;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
     //! @brief Serialize the current local_pose and publish to the IO stream(s)
     void write_local_pose_topic();
     static void update_topic(geometry_msgs_msg_PoseStamped& msg);
@@ -145,8 +140,6 @@ private:
 
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
     geometry_msgs_msg_TwistStamped tx_local_velocity_topic;
-    // The last ms timestamp AP_DDS wrote a Local Velocity message
-    uint64_t last_local_velocity_time_ms;
     //! @brief Serialize the current local velocity and publish to the IO stream(s)
     void write_tx_local_velocity_topic();
     static void update_topic(geometry_msgs_msg_TwistStamped& msg);
@@ -154,8 +147,6 @@ private:
 
 #if AP_DDS_AIRSPEED_PUB_ENABLED
     geometry_msgs_msg_Vector3Stamped tx_local_airspeed_topic;
-    // The last ms timestamp AP_DDS wrote a airspeed message
-    uint64_t last_airspeed_time_ms;
     //! @brief Serialize the current local airspeed and publish to the IO stream(s)
     void write_tx_local_airspeed_topic();
     static bool update_topic(geometry_msgs_msg_Vector3Stamped& msg);
@@ -163,8 +154,6 @@ private:
 
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
     sensor_msgs_msg_BatteryState battery_state_topic;
-    // The last ms timestamp AP_DDS wrote a BatteryState message
-    uint64_t last_battery_state_time_ms;
     //! @brief Serialize the current nav_sat_fix state and publish it to the IO stream(s)
     void write_battery_state_topic();
     static void update_topic(sensor_msgs_msg_BatteryState& msg, const uint8_t instance);
@@ -181,8 +170,6 @@ private:
 
 #if AP_DDS_IMU_PUB_ENABLED
     sensor_msgs_msg_Imu imu_topic;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
     static void update_topic(sensor_msgs_msg_Imu& msg);
     //! @brief Serialize the current IMU data and publish to the IO stream(s)
     void write_imu_topic();
@@ -190,8 +177,6 @@ private:
 
 #if AP_DDS_CLOCK_PUB_ENABLED
     rosgraph_msgs_msg_Clock clock_topic;
-    // The last ms timestamp AP_DDS wrote a Clock message
-    uint64_t last_clock_time_ms;
     //! @brief Serialize the current clock and publish to the IO stream(s)
     void write_clock_topic();
     static void update_topic(rosgraph_msgs_msg_Clock& msg);
@@ -200,8 +185,6 @@ private:
 #if AP_DDS_STATUS_PUB_ENABLED
     ardupilot_msgs_msg_Status status_topic;
     bool update_topic(ardupilot_msgs_msg_Status& msg);
-    // The last ms timestamp AP_DDS wrote/checked a status message
-    uint64_t last_status_check_time_ms;
     // last status values;
     ardupilot_msgs_msg_Status last_status_msg_;
     //! @brief Serialize the current status and publish to the IO stream(s)
@@ -242,6 +225,68 @@ private:
     static rcl_interfaces_msg_Parameter param;
 #endif
 
+    // topics published periodically by update(). The ids index the
+    // rate parameters so must not be reordered
+    enum class PubId : uint8_t {
+        TIME = 0,
+        NAV_SAT_FIX,
+        BATTERY_STATE,
+        LOCAL_POSE,
+        LOCAL_VELOCITY,
+        AIRSPEED,
+        IMU,
+        GEO_POSE,
+        CLOCK,
+        GPS_GLOBAL_ORIGIN,
+        GOAL,
+        STATUS,
+        COUNT
+    };
+    struct Publisher {
+        PubId id;
+        const char name[5];
+    };
+    // publishers in priority order, highest first
+    static const Publisher publishers[];
+
+    //! @brief Gather the latest data for a topic and queue it on the output stream
+    void publish(PubId id);
+
+    // reserve space for a topic on the reliable output stream
+    bool prepare_output_stream(const uxrObjectId &dw_id, ucdrBuffer &ub, uint32_t topic_size);
+
+    // publish rate of each topic in Hz, zero to disable
+    AP_Int16 pub_rate_hz[uint8_t(PubId::COUNT)];
+
+    // bytes per second the publishers may queue, zero for no limit
+    AP_Int32 bw_limit;
+
+    struct PublisherState {
+        uint64_t next_due_us;
+        // bytes queued by the last publish, used for budgeting
+        uint16_t last_bytes;
+        // statistics for the current window
+        uint16_t count;
+        uint16_t drops;
+        uint16_t deferred;
+        uint16_t time_us_max;
+        uint32_t time_us_total;
+        uint32_t bytes;
+    } pub_state[uint8_t(PubId::COUNT)];
+
+    struct {
+        // bandwidth budget in bytes
+        float tokens;
+        uint64_t last_refill_us;
+        uint64_t window_start_us;
+        // bytes queued and stream full events in the current publish
+        uint32_t bytes_queued;
+        bool stream_full;
+    } sched;
+
+    //! @brief Log and reset the publisher statistics
+    void write_publisher_stats(uint64_t now_us);
+
     // connection parametrics
     bool status_ok{false};
     bool connected{false};
@@ -289,6 +334,21 @@ private:
         uxrCustomTransport transport;
         SocketAPM *socket;
     } udp;
+#endif
+#if AP_DDS_SHM_ENABLED
+    // functions for shared memory transport
+    bool ddsShmInit();
+    static bool shm_transport_open(uxrCustomTransport* args);
+    static bool shm_transport_close(uxrCustomTransport* transport);
+    static size_t shm_transport_write(uxrCustomTransport* transport, const uint8_t* buf, size_t len, uint8_t* error);
+    static size_t shm_transport_read(uxrCustomTransport* transport, uint8_t* buf, size_t len, int timeout, uint8_t* error);
+
+    struct {
+        AP_Int8 enable;
+        uxrCustomTransport transport;
+        AP_DDS_SHM_Region *region;
+        int fd;
+    } shm;
 #endif
     // pointer to transport's communication structure
     uxrCommunication *comm{nullptr};
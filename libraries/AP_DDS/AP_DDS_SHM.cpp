@@ -0,0 +1,215 @@
+#include "AP_DDS_Client.h"
+
+#if AP_DDS_SHM_ENABLED
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <AP_Common/AP_Common.h>
+#include <GCS_MAVLink/GCS.h>
+
+/*
+  shared memory packet ring
+ */
+void AP_DDS_SHM_Ring::reset()
+{
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+}
+
+void AP_DDS_SHM_Ring::copy_in(uint32_t ofs, const uint8_t *src, uint32_t n)
+{
+    ofs &= (AP_DDS_SHM_RING_SIZE-1);
+    const uint32_t n1 = MIN(n, AP_DDS_SHM_RING_SIZE - ofs);
+    memcpy(&data[ofs], src, n1);
+    memcpy(&data[0], &src[n1], n - n1);
+}
+
+void AP_DDS_SHM_Ring::copy_out(uint32_t ofs, uint8_t *dst, uint32_t n) const
+{
+    ofs &= (AP_DDS_SHM_RING_SIZE-1);
+    const uint32_t n1 = MIN(n, AP_DDS_SHM_RING_SIZE - ofs);
+    memcpy(dst, &data[ofs], n1);
+    memcpy(&dst[n1], &data[0], n - n1);
+}
+
+bool AP_DDS_SHM_Ring::write(const uint8_t *buf, uint16_t len)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    const uint32_t t = tail.load(std::memory_order_acquire);
+    if (AP_DDS_SHM_RING_SIZE - (h - t) < uint32_t(len) + 2U) {
+        return false;
+    }
+    const uint8_t hdr[2] { uint8_t(len & 0xFF), uint8_t(len >> 8) };
+    copy_in(h, hdr, sizeof(hdr));
+    copy_in(h + sizeof(hdr), buf, len);
+    // publish the packet to the consumer
+    head.store(h + sizeof(hdr) + len, std::memory_order_release);
+    return true;
+}
+
+uint16_t AP_DDS_SHM_Ring::read(uint8_t *buf, uint16_t len)
+{
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    const uint32_t h = head.load(std::memory_order_acquire);
+    const uint32_t avail = h - t;
+    if (avail < 2) {
+        return 0;
+    }
+    uint8_t hdr[2];
+    copy_out(t, hdr, sizeof(hdr));
+    const uint16_t plen = hdr[0] | (uint16_t(hdr[1]) << 8);
+    if (avail < sizeof(hdr) + plen || avail > AP_DDS_SHM_RING_SIZE) {
+        // corrupt ring, the other side has misbehaved
+        tail.store(h, std::memory_order_release);
+        return 0;
+    }
+    const bool fits = plen <= len;
+    if (fits) {
+        copy_out(t + sizeof(hdr), buf, plen);
+    }
+    tail.store(t + sizeof(hdr) + plen, std::memory_order_release);
+    return fits ? plen : 0;
+}
+
+/*
+  create and map the shared memory region
+ */
+bool AP_DDS_Client::shm_transport_open(uxrCustomTransport *t)
+{
+    AP_DDS_Client *dds = (AP_DDS_Client *)t->args;
+    char name[32];
+    hal.util->snprintf(name, sizeof(name), "/ap_dds_%d", int(dds->domain_id.get()));
+
+    const int fd = shm_open(name, O_CREAT | O_RDWR, AP_DDS_SHM_MODE);
+    if (fd == -1) {
+        return false;
+    }
+    // a region left from an earlier run keeps its old mode, and one
+    // created by another user can't be changed, so refuse it
+    if (fchmod(fd, AP_DDS_SHM_MODE) != 0) {
+        close(fd);
+        return false;
+    }
+    // each ring has a single producer, so another vehicle using the
+    // same domain must not reset and write to them. The lock is
+    // released by the kernel if we exit, so a stale region is reused
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "%s %s in use, set a different DDS_DOMAIN_ID", msg_prefix, name);
+        close(fd);
+        return false;
+    }
+    if (ftruncate(fd, sizeof(AP_DDS_SHM_Region)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(AP_DDS_SHM_Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    auto *region = (AP_DDS_SHM_Region *)p;
+    region->magic.store(0, std::memory_order_relaxed);
+    region->version = AP_DDS_SHM_VERSION;
+    region->mtu = AP_DDS_SHM_MTU;
+    region->to_agent.reset();
+    region->from_agent.reset();
+    // tell the agent the region is ready
+    region->magic.store(AP_DDS_SHM_MAGIC, std::memory_order_release);
+
+    dds->shm.region = region;
+    // keep the descriptor open to hold the lock
+    dds->shm.fd = fd;
+    return true;
+}
+
+/*
+  unmap the shared memory region
+ */
+bool AP_DDS_Client::shm_transport_close(uxrCustomTransport *t)
+{
+    AP_DDS_Client *dds = (AP_DDS_Client *)t->args;
+    if (dds->shm.region == nullptr) {
+        return true;
+    }
+    dds->shm.region->magic.store(0, std::memory_order_release);
+    munmap(dds->shm.region, sizeof(AP_DDS_SHM_Region));
+    dds->shm.region = nullptr;
+    close(dds->shm.fd);
+    return true;
+}
+
+/*
+  write a packet to the agent
+ */
+size_t AP_DDS_Client::shm_transport_write(uxrCustomTransport *t, const uint8_t* buf, size_t len, uint8_t* error)
+{
+    AP_DDS_Client *dds = (AP_DDS_Client *)t->args;
+    if (dds->shm.region == nullptr || len > AP_DDS_SHM_MTU) {
+        *error = EINVAL;
+        return 0;
+    }
+    if (!dds->shm.region->to_agent.write(buf, len)) {
+        // agent is not keeping up
+        *error = ENOBUFS;
+        return 0;
+    }
+    *error = 0;
+    return len;
+}
+
+/*
+  read a packet from the agent
+ */
+size_t AP_DDS_Client::shm_transport_read(uxrCustomTransport *t, uint8_t* buf, size_t len, int timeout_ms, uint8_t* error)
+{
+    AP_DDS_Client *dds = (AP_DDS_Client *)t->args;
+    if (dds->shm.region == nullptr) {
+        *error = EINVAL;
+        return 0;
+    }
+    AP_DDS_SHM_Ring &ring = dds->shm.region->from_agent;
+    const uint32_t tstart = AP_HAL::millis();
+    while (!ring.available() &&
+           AP_HAL::millis() - tstart < uint32_t(timeout_ms)) {
+        hal.scheduler->delay_microseconds(100);
+    }
+    const uint16_t ret = ring.read(buf, MIN(len, size_t(UINT16_MAX)));
+    if (ret == 0) {
+        *error = 1;
+        return 0;
+    }
+    *error = 0;
+    return ret;
+}
+
+/*
+  initialise shared memory connection
+ */
+bool AP_DDS_Client::ddsShmInit()
+{
+    if (shm.enable.get() == 0) {
+        return false;
+    }
+
+    // setup a non-framed transport, the ring preserves packet boundaries
+    uxr_set_custom_transport_callbacks(&shm.transport, false,
+                                       shm_transport_open,
+                                       shm_transport_close,
+                                       shm_transport_write,
+                                       shm_transport_read);
+
+    if (!uxr_init_custom_transport(&shm.transport, (void*)this)) {
+        return false;
+    }
+    shm.transport.comm.mtu = AP_DDS_SHM_MTU;
+    comm = &shm.transport.comm;
+    return true;
+}
+#endif // AP_DDS_SHM_ENABLED
@@ -0,0 +1,80 @@
+/*
+  shared memory transport between the DDS client and an XRCE agent
+  running on the same computer.
+
+  The region is created with shm_open() as /ap_dds_<DDS_DOMAIN_ID> and
+  holds one ring per direction. The client holds an flock() on it, so
+  a second client on the same domain fails to open it. Each ring is single producer, single
+  consumer and carries whole XRCE packets, each prefixed by a little
+  endian uint16_t length. head and tail are free running byte counts,
+  only the producer writes head and only the consumer writes tail.
+
+  Layout, all fields little endian:
+    0      uint32_t magic, set last once the rings are reset
+    4      uint16_t version
+    6      uint16_t mtu
+    8      ring to_agent:   uint32_t head, uint32_t tail, uint8_t data[AP_DDS_SHM_RING_SIZE]
+    16+N   ring from_agent: uint32_t head, uint32_t tail, uint8_t data[AP_DDS_SHM_RING_SIZE]
+ */
+#pragma once
+
+#include "AP_DDS_config.h"
+
+#if AP_DDS_SHM_ENABLED
+
+#include <stdint.h>
+#include <atomic>
+
+#define AP_DDS_SHM_MAGIC   0x53444441 // "ADDS"
+#define AP_DDS_SHM_VERSION 1
+
+// bytes of packet data per direction, must be a power of 2
+#ifndef AP_DDS_SHM_RING_SIZE
+#define AP_DDS_SHM_RING_SIZE (128*1024U)
+#endif
+
+// permissions of the region, only the agent's user may attach. Use 0660
+// when the agent runs as another user in the same group
+#ifndef AP_DDS_SHM_MODE
+#define AP_DDS_SHM_MODE 0600
+#endif
+
+static_assert((AP_DDS_SHM_RING_SIZE & (AP_DDS_SHM_RING_SIZE-1)) == 0, "AP_DDS_SHM_RING_SIZE must be a power of 2");
+static_assert(sizeof(std::atomic<uint32_t>) == 4, "ring indexes must be plain 32 bit words");
+
+class AP_DDS_SHM_Ring
+{
+public:
+    // empty the ring. Only valid while neither side is using it
+    void reset();
+
+    // queue a packet, false if there is not enough space for all of it
+    bool write(const uint8_t *buf, uint16_t len);
+
+    // dequeue a packet, returning its length or 0 if the ring is
+    // empty. Packets larger than len are discarded
+    uint16_t read(uint8_t *buf, uint16_t len);
+
+    // true if a packet is waiting
+    bool available() const {
+        return head.load(std::memory_order_acquire) != tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    void copy_in(uint32_t ofs, const uint8_t *src, uint32_t n);
+    void copy_out(uint32_t ofs, uint8_t *dst, uint32_t n) const;
+
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    uint8_t data[AP_DDS_SHM_RING_SIZE];
+};
+
+struct AP_DDS_SHM_Region {
+    std::atomic<uint32_t> magic;
+    uint16_t version;
+    uint16_t mtu;
+    AP_DDS_SHM_Ring to_agent;
+    AP_DDS_SHM_Ring from_agent;
+};
+
+#endif // AP_DDS_SHM_ENABLED
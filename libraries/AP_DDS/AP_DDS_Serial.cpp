@@ -90,6 +90,8 @@ bool AP_DDS_Client::ddsSerialInit()
     if (!uxr_init_custom_transport(&serial.transport, (void*)this)) {
         return false;
     }
+    // the custom transport buffers may be sized for shared memory
+    serial.transport.comm.mtu = DDS_MTU;
     comm = &serial.transport.comm;
     return true;
 }
@@ -83,6 +83,8 @@ bool AP_DDS_Client::ddsUdpInit()
     if (!uxr_init_custom_transport(&udp.transport, (void*)this)) {
         return false;
     }
+    // the custom transport buffers may be sized for shared memory
+    udp.transport.comm.mtu = DDS_MTU;
     comm = &udp.transport.comm;
     return true;
 }
@@ -12,6 +12,28 @@
 #define AP_DDS_UDP_ENABLED AP_DDS_ENABLED && AP_NETWORKING_ENABLED
 #endif
 
+// shared memory transport to an agent on the same computer
+#ifndef AP_DDS_SHM_ENABLED
+#define AP_DDS_SHM_ENABLED AP_DDS_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// MTU of the shared memory transport, so an IMU or pose sample fits
+// in one packet. Serial and UDP keep DDS_MTU
+#ifndef AP_DDS_SHM_MTU
+#define AP_DDS_SHM_MTU 2048
+#endif
+
+// receive buffer size of the custom transports, the largest MTU of
+// any of them. This must match the UCLIENT_CUSTOM_TRANSPORT_MTU the
+// wscript passes to gen_config_h.py
+#ifndef AP_DDS_CUSTOM_TRANSPORT_MTU
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_DDS_CUSTOM_TRANSPORT_MTU AP_DDS_SHM_MTU
+#else
+#define AP_DDS_CUSTOM_TRANSPORT_MTU 512
+#endif
+#endif
+
 #include <AP_VisualOdom/AP_VisualOdom_config.h>
 #ifndef AP_DDS_VISUALODOM_ENABLED
 #define AP_DDS_VISUALODOM_ENABLED HAL_VISUALODOM_ENABLED && AP_DDS_ENABLED
@@ -42,6 +64,11 @@
 #define AP_DDS_NAVSATFIX_PUB_ENABLED 1
 #endif
 
+// interval for checking the GPS receivers for a new fix
+#ifndef AP_DDS_DELAY_NAVSATFIX_TOPIC_MS
+#define AP_DDS_DELAY_NAVSATFIX_TOPIC_MS 20
+#endif
+
 #ifndef AP_DDS_STATIC_TF_PUB_ENABLED
 #define AP_DDS_STATIC_TF_PUB_ENABLED 1
 #endif
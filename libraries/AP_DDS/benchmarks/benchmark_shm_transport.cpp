@@ -0,0 +1,168 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_DDS/AP_DDS_config.h>
+
+#if AP_DDS_SHM_ENABLED && AP_DDS_IMU_PUB_ENABLED && AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+#include <AP_DDS/AP_DDS_Client.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_RTC/AP_RTC.h>
+#include <AP_HAL/utility/Socket_native.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <sys/mman.h>
+#include <atomic>
+#include <thread>
+
+// shared memory transport against UDP loopback, and the client's IMU and pose publish rate over it
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// size of an XRCE WRITE_DATA packet carrying a sensor_msgs/Imu and a
+// geometry_msgs/PoseStamped with frame_id "base_link"
+static const uint16_t imu_packet_len = 352;
+static const uint16_t pose_packet_len = 112;
+
+static const uint16_t udp_bench_port = 15819;
+
+// out of the way of a SITL on the default domain
+static const int32_t bench_domain_id = 232;
+
+static AP_DDS_SHM_Region region;
+
+GCS_Dummy _gcs;
+static AP_InertialSensor ins;
+static AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+static AP_RTC rtc;
+
+/*
+  a client publishing over its shared memory transport with no agent
+  attached. The output stream is best effort as nothing acknowledges
+  the reliable one, the packets are otherwise those update() sends
+ */
+class AP_DDS_Client_Benchmark
+{
+public:
+    bool init()
+    {
+        client.shm.enable.set(1);
+        client.domain_id.set(bench_domain_id);
+        client.is_using_shm = true;
+        if (!client.ddsShmInit()) {
+            return false;
+        }
+        uxr_init_session(&client.session, client.comm, client.key);
+        client.reliable_out = uxr_create_output_best_effort_stream(&client.session, stream, client.comm->mtu);
+        client.connected = true;
+        return true;
+    }
+
+    // the IMU and pose slots of update(), and sending them
+    void publish_imu_pose()
+    {
+        WITH_SEMAPHORE(client.csem);
+        client.publish(AP_DDS_Client::PubId::IMU);
+        client.publish(AP_DDS_Client::PubId::LOCAL_POSE);
+        uxr_flash_output_streams(&client.session);
+    }
+
+    AP_DDS_SHM_Ring &to_agent()
+    {
+        return client.shm.region->to_agent;
+    }
+
+    // remove the region once the client has closed it
+    static void unlink()
+    {
+        char name[32];
+        hal.util->snprintf(name, sizeof(name), "/ap_dds_%d", int(bench_domain_id));
+        shm_unlink(name);
+    }
+
+private:
+    AP_DDS_Client client;
+    uint8_t stream[AP_DDS_SHM_MTU];
+};
+
+// one packet written and read back on the same thread
+static void BM_ShmRingPacket(benchmark::State& state)
+{
+    const uint16_t len = state.range(0);
+    uint8_t tx[AP_DDS_SHM_MTU] {};
+    uint8_t rx[AP_DDS_SHM_MTU];
+    region.to_agent.reset();
+
+    while (state.KeepRunning()) {
+        region.to_agent.write(tx, len);
+        uint16_t n = region.to_agent.read(rx, sizeof(rx));
+        gbenchmark_escape(&n);
+    }
+    state.SetBytesProcessed(state.iterations() * len);
+}
+
+// the same packet over a UDP socket on the loopback interface
+static void BM_UdpLoopbackPacket(benchmark::State& state)
+{
+    const uint16_t len = state.range(0);
+    uint8_t tx[AP_DDS_SHM_MTU] {};
+    uint8_t rx[AP_DDS_SHM_MTU];
+    SocketAPM_native sock_rx{true};
+    SocketAPM_native sock_tx{true};
+    if (!sock_rx.bind("127.0.0.1", udp_bench_port) ||
+        !sock_tx.connect("127.0.0.1", udp_bench_port)) {
+        state.SkipWithError("UDP loopback unavailable");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        sock_tx.send(tx, len);
+        ssize_t n = sock_rx.recv(rx, sizeof(rx), 10);
+        gbenchmark_escape(&n);
+    }
+    state.SetBytesProcessed(state.iterations() * len);
+}
+
+/*
+  the client filling, serializing and sending one IMU and one pose
+  sample per iteration, with an agent thread draining the ring. items/s
+  is the highest rate both topics can be published at
+ */
+static void BM_ClientImuPosePublish(benchmark::State& state)
+{
+    auto *bench = NEW_NOTHROW AP_DDS_Client_Benchmark();
+    if (bench == nullptr || !bench->init()) {
+        delete bench;
+        AP_DDS_Client_Benchmark::unlink();
+        state.SkipWithError("shared memory unavailable");
+        return;
+    }
+    AP_DDS_SHM_Ring &ring = bench->to_agent();
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> bytes{0};
+    std::thread agent([&]() {
+        uint8_t rx[AP_DDS_SHM_MTU];
+        while (running.load(std::memory_order_relaxed) || ring.available()) {
+            bytes.fetch_add(ring.read(rx, sizeof(rx)), std::memory_order_relaxed);
+        }
+    });
+
+    while (state.KeepRunning()) {
+        bench->publish_imu_pose();
+    }
+
+    running = false;
+    agent.join();
+    delete bench;
+    AP_DDS_Client_Benchmark::unlink();
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes.load());
+}
+
+BENCHMARK(BM_ShmRingPacket)->Arg(pose_packet_len)->Arg(imu_packet_len)->Arg(AP_DDS_SHM_MTU);
+BENCHMARK(BM_UdpLoopbackPacket)->Arg(pose_packet_len)->Arg(imu_packet_len)->Arg(AP_DDS_SHM_MTU);
+BENCHMARK(BM_ClientImuPosePublish);
+
+#endif // AP_DDS_SHM_ENABLED && AP_DDS_IMU_PUB_ENABLED && AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+BENCHMARK_MAIN();
@@ -5,6 +5,7 @@
 
 # TODO move to AP_DDS_Client/tools
 
+import argparse
 import re
 import sys
 
@@ -53,8 +54,16 @@ defines = {
     "UCLIENT_HARD_LIVELINESS_CHECK": 0,
 }
 
-h_in = sys.argv[1]
-h = sys.argv[2]
+parser = argparse.ArgumentParser(description=__doc__)
+parser.add_argument('h_in')
+parser.add_argument('h')
+parser.add_argument('--custom-transport-mtu', type=int, default=config['UCLIENT_CUSTOM_TRANSPORT_MTU'])
+args = parser.parse_args()
+
+config['UCLIENT_CUSTOM_TRANSPORT_MTU'] = args.custom_transport_mtu
+
+h_in = args.h_in
+h = args.h
 print("Processing %s to %s" % (h_in, h))
 
 txt = open(h_in, 'r').read()
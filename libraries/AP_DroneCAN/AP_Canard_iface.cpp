@@ -64,6 +64,9 @@ Interface(iface_index) {
 
 void CanardInterface::init(void* mem_arena, size_t mem_arena_size, uint8_t node_id) {
     canardInit(&canard, mem_arena, mem_arena_size, onTransferReception, shouldAcceptTransfer, this);
+    // use our own semaphore for the pool so canard_allocate_sem_take()
+    // does not need to allocate one on first use
+    canard.allocator.semaphore = &_sem_pool;
     canardSetLocalNodeID(&canard, node_id);
     initialized = true;
 }
@@ -98,16 +101,16 @@ bool CanardInterface::broadcast(const Canard::Transfer &bcast_transfer) {
     };
     // do canard broadcast
     int16_t ret = canardBroadcastObj(&canard, &tx_transfer);
+    if (ret == -CANARD_ERROR_OUT_OF_MEMORY && pop_sent_frames() > 0) {
+        // frames already sent were holding the pool, try again
+        ret = canardBroadcastObj(&canard, &tx_transfer);
+    }
 #if AP_TEST_DRONECAN_DRIVERS
     if (this == &test_iface) {
         test_iface_sem.give();
     }
 #endif
-    if (ret <= 0) {
-        protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
-    }
+    update_tx_protocol_stats(ret);
     return ret > 0;
 }
 
@@ -135,11 +138,10 @@ bool CanardInterface::request(uint8_t destination_node_id, const Canard::Transfe
     };
     // do canard request
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
-    if (ret <= 0) {
-        protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
+    if (ret == -CANARD_ERROR_OUT_OF_MEMORY && pop_sent_frames() > 0) {
+        ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
     }
+    update_tx_protocol_stats(ret);
     return ret > 0;
 }
 
@@ -167,11 +169,10 @@ bool CanardInterface::respond(uint8_t destination_node_id, const Canard::Transfe
     };
     // do canard respond
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
-    if (ret <= 0) {
-        protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
+    if (ret == -CANARD_ERROR_OUT_OF_MEMORY && pop_sent_frames() > 0) {
+        ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
     }
+    update_tx_protocol_stats(ret);
     return ret > 0;
 }
 
@@ -213,7 +214,7 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
         }
         auto txq = canard.tx_queue;
         if (txq == nullptr) {
-            return;
+            break;
         }
         // volatile as the value can change at any time during can interrupt
         // we need to ensure that this is not optimized
@@ -229,17 +230,24 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
             */
             iface_down = false;
         } 
-        // scan through list of pending transfers
-        while (true) {
+        const uint64_t now_us = AP_HAL::micros64();
+        const uint8_t iface_bit = 1U<<iface;
+        uint16_t batch_len = 0;
+        // the queue is sorted by priority, submit frames for this
+        // interface in order until the interface is full
+        for (; txq != nullptr; txq = txq->next) {
             auto txf = &txq->frame;
+            if (!(txf->iface_mask & iface_bit)) {
+                // already sent on this interface, waiting to be popped
+                continue;
+            }
             if (raw_commands_only &&
                 CANARD_MSG_TYPE_FROM_ID(txf->id) != UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID &&
                 CANARD_MSG_TYPE_FROM_ID(txf->id) != COM_HOBBYWING_ESC_RAWCOMMAND_ID) {
-                // look at next transfer
-                txq = txq->next;
-                if (txq == nullptr) {
-                    break;
-                }
+                continue;
+            }
+            if (now_us >= txf->deadline_usec) {
+                // stale, removed by canardCleanupStaleTransfers()
                 continue;
             }
             AP_HAL::CANFrame txmsg {};
@@ -252,35 +260,72 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
             bool write = true;
             bool read = false;
             ifaces[iface]->select(read, write, &txmsg, 0);
-            if (!write) {
-                // if there is no space then we need to start from the
-                // top of the queue, so wait for the next loop
-                if (!iface_down) {
-                    break;
-                } else {
-                    txf->iface_mask &= ~(1U<<iface);
-                }
-            } else if ((txf->iface_mask & (1U<<iface)) && (AP_HAL::micros64() < txf->deadline_usec)) {
-                // try sending to interfaces, clearing the mask if we succeed
-                if (ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
-                    txf->iface_mask &= ~(1U<<iface);
-                } else {
-                    // if we fail to send then we try sending on next interface
-                    if (!iface_down) {
-                        break;
-                    } else {
-                        txf->iface_mask &= ~(1U<<iface);
-                    }
-                }
+            if (write && ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
+                txf->iface_mask &= ~iface_bit;
+                batch_len++;
+                continue;
             }
-            // look at next transfer
-            txq = txq->next;
-            if (txq == nullptr) {
+            // if there is no space then we need to start from the top
+            // of the queue on the next call so that priority order is
+            // kept. A down interface drops the frame instead
+            if (!iface_down) {
                 break;
             }
+            txf->iface_mask &= ~iface_bit;
         }
+        if (batch_len > 0) {
+            tx_stats.batches++;
+            tx_stats.batch_max = MAX(tx_stats.batch_max, batch_len);
+        }
+    }
+
+    // release frames sent on all interfaces straight away so the
+    // memory pool does not fill up between calls to process()
+    pop_sent_frames();
+}
+
+/*
+  pop frames from the head of the tx queue that have been sent on all
+  interfaces or have timed out, returning the number popped. Must be
+  called with _sem_tx held
+ */
+uint16_t CanardInterface::pop_sent_frames()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    uint16_t count = 0;
+    for (const CanardCANFrame *txf = canardPeekTxQueue(&canard);
+         txf != nullptr && (txf->iface_mask == 0 || now_us >= txf->deadline_usec);
+         txf = canardPeekTxQueue(&canard)) {
+        canardPopTxQueue(&canard);
+        count++;
+    }
+    tx_stats.frames_popped += count;
+    return count;
+}
+
+void CanardInterface::update_tx_protocol_stats(int16_t res)
+{
+    if (res > 0) {
+        protocol_stats.tx_frames += res;
+        return;
+    }
+    protocol_stats.tx_errors++;
+    if (res == -CANARD_ERROR_OUT_OF_MEMORY) {
+        tx_stats.oom++;
     }
+}
 
+/*
+  get memory pool usage and the number of frames waiting to be sent
+ */
+void CanardInterface::get_pool_stats(CanardPoolAllocatorStatistics &pool, uint16_t &tx_queue_len)
+{
+    WITH_SEMAPHORE(_sem_tx);
+    pool = canardGetPoolAllocatorStatistics(&canard);
+    tx_queue_len = 0;
+    for (auto txq = canard.tx_queue; txq != nullptr; txq = txq->next) {
+        tx_queue_len++;
+    }
 }
 
 void CanardInterface::update_rx_protocol_stats(int16_t res)
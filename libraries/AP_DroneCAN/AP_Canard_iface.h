@@ -62,6 +62,20 @@ public:
 #endif
 
     void update_rx_protocol_stats(int16_t res);
+    void update_tx_protocol_stats(int16_t res);
+
+    // transmit statistics not covered by dronecan_protocol_Stats
+    struct TxStats {
+        uint32_t oom;           // transfers not queued as the memory pool was full
+        uint32_t frames_popped; // frames released as soon as they were sent or timed out
+        uint32_t batches;       // calls to processTx() that sent frames on an interface
+        uint16_t batch_max;     // most frames sent on an interface in one call
+    };
+    const TxStats &get_tx_stats() const { return tx_stats; }
+    const dronecan_protocol_Stats &get_protocol_stats() const { return protocol_stats; }
+
+    // get memory pool usage and the number of frames waiting to be sent
+    void get_pool_stats(CanardPoolAllocatorStatistics &pool, uint16_t &tx_queue_len);
 
     uint8_t get_node_id() const override { return canard.node_id; }
 private:
@@ -76,8 +90,13 @@ private:
     bool initialized;
     HAL_Semaphore _sem_tx;
     HAL_Semaphore _sem_rx;
+    HAL_Semaphore _sem_pool;
     CanardTxTransfer tx_transfer;
     dronecan_protocol_Stats protocol_stats;
+    TxStats tx_stats;
+
+    // pop frames sent on all interfaces from the head of the tx queue
+    uint16_t pop_sent_frames();
 
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
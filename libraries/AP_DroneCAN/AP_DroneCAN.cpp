@@ -1991,6 +1991,39 @@ void AP_DroneCAN::logging(void)
                                 _esc_send_count,
                                 _srv_send_count,
                                 _fail_send_count);
+
+    CanardPoolAllocatorStatistics pool;
+    uint16_t tx_queue_len;
+    canard_iface.get_pool_stats(pool, tx_queue_len);
+    const auto &tx_stats = canard_iface.get_tx_stats();
+
+// @LoggerMessage: CANP
+// @Description: DroneCAN memory pool and transmit queue statistics
+// @Field: TimeUS: Time since system startup
+// @Field: I: driver index
+// @Field: Cap: memory pool capacity in blocks
+// @Field: Use: memory pool blocks in use
+// @Field: Peak: most memory pool blocks used at once
+// @Field: TxQ: frames waiting to be sent
+// @Field: Toom: transfers not sent as the memory pool was full
+// @Field: Room: transfers not received as the memory pool was full
+// @Field: Pop: frames released as soon as they were sent or timed out
+// @Field: Bmax: most frames sent on one interface in a single transmit pass
+    AP::logger().WriteStreaming("CANP",
+                                "TimeUS,I,Cap,Use,Peak,TxQ,Toom,Room,Pop,Bmax",
+                                "s#--------",
+                                "F---------",
+                                "QBHHHHIIIH",
+                                AP_HAL::micros64(),
+                                _driver_index,
+                                pool.capacity_blocks,
+                                pool.current_usage_blocks,
+                                pool.peak_usage_blocks,
+                                tx_queue_len,
+                                tx_stats.oom,
+                                uint32_t(canard_iface.get_protocol_stats().rx_error_oom),
+                                tx_stats.frames_popped,
+                                tx_stats.batch_max);
 #endif // HAL_LOGGING_ENABLED
 }
 
@@ -39,6 +39,11 @@ extern const AP_HAL::HAL& hal;
 #define MAX_NODE_ID    125
 #define NODERECORD_LOC(node_id) ((node_id * sizeof(NodeRecord)) + NODERECORD_MAGIC_LEN)
 
+// dirty records are written once registrations have been unchanged for
+// FLUSH_IDLE_MS, or FLUSH_MAX_DELAY_MS after the first change
+#define FLUSH_IDLE_MS       200
+#define FLUSH_MAX_DELAY_MS  2000
+
 #define debug_dronecan(level_debug, fmt, args...) do { AP::can().log_text(level_debug, "DroneCAN", fmt, ##args); } while (0)
 
 // database is currently shared by all DNA servers
@@ -49,10 +54,16 @@ void AP_DroneCAN_DNA_Server::Database::init(StorageAccess *storage_)
 {
     // storage size must be synced with StorageCANDNA entry in StorageManager.cpp
     static_assert(NODERECORD_LOC(MAX_NODE_ID+1) <= 1024, "DNA storage too small");
+    static_assert(sizeof(NodeRecord) == 7, "NodeRecord must match the storage layout");
+    static_assert(ARRAY_SIZE(records) > MAX_NODE_ID, "records too small");
 
     // might be called from multiple threads if multiple servers use the same database
     WITH_SEMAPHORE(sem);
 
+    if (storage != nullptr) {
+        // another server may have registrations not yet written
+        flush(true);
+    }
     storage = storage_; // use supplied accessor
 
     // validate magic number
@@ -61,7 +72,12 @@ void AP_DroneCAN_DNA_Server::Database::init(StorageAccess *storage_)
         reset(); // resetting the database will put the magic back
     }
 
+    // read all records in one go, after this only writes go to storage
+    node_dirty.clearall();
+    storage->read_block(records, NODERECORD_LOC(0), (MAX_NODE_ID+1)*sizeof(NodeRecord));
+
     // check and note each possible node ID's registration's presence
+    node_registered.clearall();
     for (uint8_t i = 1; i <= MAX_NODE_ID; i++) {
         if (check_registration(i)) {
             node_registered.set(i);
@@ -74,15 +90,15 @@ void AP_DroneCAN_DNA_Server::Database::reset()
 {
     WITH_SEMAPHORE(sem);
 
-    NodeRecord record;
-    memset(&record, 0, sizeof(record));
+    memset(records, 0, sizeof(records));
     node_registered.clearall();
 
     // all-zero record means no registration
     // ensure node ID 0 is cleared even if we can't use it so we know the state
     for (uint8_t i = 0; i <= MAX_NODE_ID; i++) {
-        write_record(record, i);
+        node_dirty.set(i);
     }
+    flush(true);
 
     // mark the magic at the start to indicate a valid (and reset) database
     storage->write_uint16(0, NODERECORD_MAGIC);
@@ -140,6 +156,36 @@ uint8_t AP_DroneCAN_DNA_Server::Database::handle_allocation(const uint8_t unique
     return resp_node_id; // will be 0 if not found and not created
 }
 
+// write dirty records to storage, merging runs of adjacent records
+void AP_DroneCAN_DNA_Server::Database::flush(bool force)
+{
+    WITH_SEMAPHORE(sem);
+
+    if (node_dirty.empty()) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (!force &&
+        now_ms - last_dirty_ms < FLUSH_IDLE_MS &&
+        now_ms - first_dirty_ms < FLUSH_MAX_DELAY_MS) {
+        return;
+    }
+
+    uint8_t node_id = 0;
+    while (node_id <= MAX_NODE_ID) {
+        if (!node_dirty.get(node_id)) {
+            node_id++;
+            continue;
+        }
+        const uint8_t start = node_id;
+        while (node_id <= MAX_NODE_ID && node_dirty.get(node_id)) {
+            node_dirty.clear(node_id);
+            node_id++;
+        }
+        storage->write_block(NODERECORD_LOC(start), &records[start], (node_id-start)*sizeof(NodeRecord));
+    }
+}
+
 // retrieve node ID that matches the given unique ID. returns 0 if not found
 uint8_t AP_DroneCAN_DNA_Server::Database::find_node_id(const uint8_t unique_id[], uint8_t size)
 {
@@ -232,17 +278,26 @@ void AP_DroneCAN_DNA_Server::Database::read_record(NodeRecord &record, uint8_t n
         return;
     }
 
-    storage->read_block(&record, NODERECORD_LOC(node_id), sizeof(NodeRecord));
+    record = records[node_id];
 }
 
-// write the given node ID's registration's record
+// write the given node ID's registration's record, it reaches storage on the next flush()
 void AP_DroneCAN_DNA_Server::Database::write_record(const NodeRecord &record, uint8_t node_id)
 {
     if (node_id > MAX_NODE_ID) {
         return;
     }
+    if (memcmp(&records[node_id], &record, sizeof(NodeRecord)) == 0) {
+        return;
+    }
 
-    storage->write_block(NODERECORD_LOC(node_id), &record, sizeof(NodeRecord));
+    records[node_id] = record;
+    const uint32_t now_ms = AP_HAL::millis();
+    if (node_dirty.empty()) {
+        first_dirty_ms = now_ms;
+    }
+    last_dirty_ms = now_ms;
+    node_dirty.set(node_id);
 }
 
 
@@ -287,6 +342,9 @@ seen list, So that we can raise issue if there are duplicates
 on the bus. */
 void AP_DroneCAN_DNA_Server::verify_nodes()
 {
+    // write back registrations once allocation has settled
+    db.flush(false);
+
     uint32_t now = AP_HAL::millis();
     if ((now - last_verification_request) < 5000) {
         return;
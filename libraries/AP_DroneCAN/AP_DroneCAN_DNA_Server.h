@@ -16,6 +16,8 @@ class AP_DroneCAN;
 //Forward declaring classes
 class AP_DroneCAN_DNA_Server
 {
+    friend class AP_DroneCAN_DNA_Server_Test;
+
     StorageAccess storage;
 
     struct NodeRecord {
@@ -37,8 +39,15 @@ class AP_DroneCAN_DNA_Server
      * The database has public methods which handle the server behavior for the
      * relevant message. The methods can be used by multiple servers in
      * different threads, so each holds a lock for its duration.
+     *
+     * All records are read into RAM at init so lookups do not touch
+     * storage. Changed records are marked dirty and written back by
+     * flush(), which merges adjacent records into a single write. This
+     * keeps an allocation storm at boot from generating a storage write
+     * per registration.
      */
     class Database {
+        friend class AP_DroneCAN_DNA_Server_Test;
     public:
         Database() {};
 
@@ -62,6 +71,11 @@ class AP_DroneCAN_DNA_Server
         // handle the allocation message. returns the allocated node ID, or 0 if allocation failed
         uint8_t handle_allocation(const uint8_t unique_id[]);
 
+        // write dirty records to storage. Unless force is set this
+        // waits until registrations have stopped changing for a short
+        // time, up to a maximum delay
+        void flush(bool force);
+
     private:
         // retrieve node ID that matches the given unique ID. returns 0 if not found
         uint8_t find_node_id(const uint8_t unique_id[], uint8_t size);
@@ -89,6 +103,14 @@ class AP_DroneCAN_DNA_Server
 
         // bitmasks containing a status for each possible node ID (except 0 and > MAX_NODE_ID)
         Bitmask<128> node_registered; // have a registration for this node ID
+        Bitmask<128> node_dirty; // record changed since it was last written to storage
+
+        // copy of the stored records, indexed by node ID
+        NodeRecord records[128];
+
+        // time of the first and latest change not yet written to storage
+        uint32_t first_dirty_ms;
+        uint32_t last_dirty_ms;
 
         StorageAccess *storage;
         HAL_Semaphore sem;
@@ -0,0 +1,216 @@
+/*
+  DroneCAN transmit throughput test. Sends the traffic of a vehicle
+  with eight ESCs at 400Hz plus low priority RTCM data and reports
+  the achieved rates, memory pool usage and the time taken by
+  CanardInterface::process() once a second.
+
+  On SITL the default CAN transport is multicast UDP, so the frames
+  can be watched with the DroneCAN_sniffer example or the DroneCAN GUI
+  tool on the same machine
+ */
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_ENABLE_DRONECAN_DRIVERS
+
+#include <AP_DroneCAN/AP_DroneCAN.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <AP_HAL_Linux/CANSocketIface.h>
+#elif CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <AP_HAL_SITL/CANSocketIface.h>
+#elif CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
+#include <hal.h>
+#include <AP_HAL_ChibiOS/CANIface.h>
+#endif
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define DRONECAN_NODE_POOL_SIZE 8192
+
+static uint8_t node_memory_pool[DRONECAN_NODE_POOL_SIZE];
+
+#define ESC_RATE_HZ 400
+#define NUM_ESCS 8
+#define RTCM_RATE_HZ 10
+#define RTCM_LEN 128
+
+static const uint8_t driver_index = 0;
+
+static CanardInterface *iface;
+static Canard::Publisher<uavcan_equipment_esc_RawCommand> *esc_pub;
+static Canard::Publisher<uavcan_equipment_gnss_RTCMStream> *rtcm_pub;
+static Canard::Publisher<uavcan_protocol_NodeStatus> *node_status_pub;
+
+static struct {
+    uint32_t esc_ok;
+    uint32_t esc_fail;
+    uint32_t rtcm_ok;
+    uint32_t rtcm_fail;
+    uint32_t process_count;
+    uint32_t process_us_total;
+    uint32_t process_us_max;
+} counters;
+
+static uint32_t last_esc_us;
+static uint32_t last_rtcm_us;
+static uint32_t last_status_ms;
+static uint32_t last_print_ms;
+static uint32_t last_tx_frames;
+
+static bool init_iface(void)
+{
+    // we need to mutate the HAL to install new CAN interfaces
+    AP_HAL::HAL& hal_mutable = AP_HAL::get_HAL_mutable();
+
+    hal_mutable.can[driver_index] = NEW_NOTHROW HAL_CANIface(driver_index);
+    if (hal_mutable.can[driver_index] == nullptr) {
+        AP_HAL::panic("Couldn't allocate CANManager, something is very wrong");
+    }
+
+    hal_mutable.can[driver_index]->init(1000000, AP_HAL::CANIface::NormalMode);
+    if (!hal_mutable.can[driver_index]->is_initialized()) {
+        hal.console->printf("CAN not initialised\n");
+        return false;
+    }
+
+    iface = NEW_NOTHROW CanardInterface{driver_index};
+    if (iface == nullptr) {
+        return false;
+    }
+    if (!iface->add_interface(hal_mutable.can[driver_index])) {
+        hal.console->printf("Failed to add iface\n");
+        return false;
+    }
+    iface->init(node_memory_pool, sizeof(node_memory_pool), 10);
+
+    esc_pub = NEW_NOTHROW Canard::Publisher<uavcan_equipment_esc_RawCommand>{*iface};
+    rtcm_pub = NEW_NOTHROW Canard::Publisher<uavcan_equipment_gnss_RTCMStream>{*iface};
+    node_status_pub = NEW_NOTHROW Canard::Publisher<uavcan_protocol_NodeStatus>{*iface};
+    if (esc_pub == nullptr || rtcm_pub == nullptr || node_status_pub == nullptr) {
+        return false;
+    }
+    esc_pub->set_priority(CANARD_TRANSFER_PRIORITY_HIGH);
+    esc_pub->set_timeout_ms(2);
+    rtcm_pub->set_priority(CANARD_TRANSFER_PRIORITY_LOW);
+    rtcm_pub->set_timeout_ms(100);
+    return true;
+}
+
+static void send_esc(void)
+{
+    uavcan_equipment_esc_RawCommand msg {};
+    msg.cmd.len = NUM_ESCS;
+    for (uint8_t i=0; i<NUM_ESCS; i++) {
+        msg.cmd.data[i] = (AP_HAL::millis() + i*100) % 8191;
+    }
+    if (esc_pub->broadcast(msg)) {
+        counters.esc_ok++;
+    } else {
+        counters.esc_fail++;
+    }
+    // push straight to the bus as AP_DroneCAN does
+    iface->processTx(true);
+}
+
+static void send_rtcm(void)
+{
+    uavcan_equipment_gnss_RTCMStream msg {};
+    msg.protocol_id = UAVCAN_EQUIPMENT_GNSS_RTCMSTREAM_PROTOCOL_ID_RTCM3;
+    msg.data.len = RTCM_LEN;
+    for (uint8_t i=0; i<RTCM_LEN; i++) {
+        msg.data.data[i] = i;
+    }
+    if (rtcm_pub->broadcast(msg)) {
+        counters.rtcm_ok++;
+    } else {
+        counters.rtcm_fail++;
+    }
+}
+
+static void print_stats(void)
+{
+    CanardPoolAllocatorStatistics pool;
+    uint16_t tx_queue_len;
+    iface->get_pool_stats(pool, tx_queue_len);
+    const auto &tx_stats = iface->get_tx_stats();
+    const uint32_t tx_frames = iface->get_protocol_stats().tx_frames;
+
+    hal.console->printf("ESC %u/%u RTCM %u/%u frames %u pool %u/%u peak %u txq %u oom %u batch_max %u process avg %uus max %uus\n",
+                        unsigned(counters.esc_ok), unsigned(counters.esc_ok + counters.esc_fail),
+                        unsigned(counters.rtcm_ok), unsigned(counters.rtcm_ok + counters.rtcm_fail),
+                        unsigned(tx_frames - last_tx_frames),
+                        unsigned(pool.current_usage_blocks), unsigned(pool.capacity_blocks),
+                        unsigned(pool.peak_usage_blocks),
+                        unsigned(tx_queue_len),
+                        unsigned(tx_stats.oom),
+                        unsigned(tx_stats.batch_max),
+                        unsigned(counters.process_us_total / MAX(counters.process_count, 1U)),
+                        unsigned(counters.process_us_max));
+    last_tx_frames = tx_frames;
+    memset(&counters, 0, sizeof(counters));
+}
+
+void setup(void)
+{
+    hal.scheduler->delay(2000);
+    hal.console->printf("Starting DroneCAN throughput test\n");
+    if (!init_iface()) {
+        AP_HAL::panic("DroneCAN init failed");
+    }
+}
+
+void loop(void)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    if (now_us - last_esc_us >= 1000000U / ESC_RATE_HZ) {
+        last_esc_us = now_us;
+        send_esc();
+    }
+    if (now_us - last_rtcm_us >= 1000000U / RTCM_RATE_HZ) {
+        last_rtcm_us = now_us;
+        send_rtcm();
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_status_ms >= 1000) {
+        last_status_ms = now_ms;
+        uavcan_protocol_NodeStatus msg {};
+        msg.uptime_sec = now_ms / 1000;
+        msg.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_OK;
+        msg.mode = UAVCAN_PROTOCOL_NODESTATUS_MODE_OPERATIONAL;
+        node_status_pub->broadcast(msg);
+    }
+
+    const uint32_t process_start_us = AP_HAL::micros();
+    iface->process(0);
+    const uint32_t process_us = AP_HAL::micros() - process_start_us;
+    counters.process_count++;
+    counters.process_us_total += process_us;
+    counters.process_us_max = MAX(counters.process_us_max, process_us);
+
+    if (now_ms - last_print_ms >= 1000) {
+        last_print_ms = now_ms;
+        print_stats();
+    }
+}
+
+AP_HAL_MAIN();
+
+#else
+
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void loop() { }
+static void setup()
+{
+    printf("Board not currently supported\n");
+}
+
+AP_HAL_MAIN();
+#endif
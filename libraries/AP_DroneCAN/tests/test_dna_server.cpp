@@ -0,0 +1,143 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_ENABLE_DRONECAN_DRIVERS
+
+#include <AP_DroneCAN/AP_DroneCAN_DNA_Server.h>
+
+#define NUM_NODES 100
+
+class AP_DroneCAN_DNA_Server_Test
+{
+public:
+    AP_DroneCAN_DNA_Server::Database db;
+    StorageAccess storage{StorageManager::StorageCANDNA};
+
+    uint16_t num_dirty() const {
+        return db.node_dirty.count();
+    }
+
+    // read a record straight from storage, bypassing the database
+    void read_stored(uint8_t node_id, uint8_t uid_hash[6]) {
+        AP_DroneCAN_DNA_Server::NodeRecord record;
+        storage.read_block(&record, 2 + node_id*sizeof(record), sizeof(record));
+        memcpy(uid_hash, record.uid_hash, sizeof(record.uid_hash));
+    }
+};
+
+static void make_unique_id(uint8_t unique_id[16], uint8_t n)
+{
+    for (uint8_t i=0; i<16; i++) {
+        unique_id[i] = uint8_t(n * 31 + i * 7 + 1);
+    }
+}
+
+static bool is_zero(const uint8_t *data, uint8_t len)
+{
+    for (uint8_t i=0; i<len; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  NUM_NODES nodes booting at once, each repeating its allocation
+  request until it sees the response, with the requests interleaved
+ */
+TEST(AP_DroneCAN_DNA_Server, AllocationStorm)
+{
+    static AP_DroneCAN_DNA_Server_Test t;
+    t.db.init(&t.storage);
+    t.db.reset();
+    EXPECT_EQ(0, t.num_dirty());
+
+    uint8_t unique_ids[NUM_NODES][16];
+    uint8_t node_ids[NUM_NODES] {};
+    for (uint8_t n=0; n<NUM_NODES; n++) {
+        make_unique_id(unique_ids[n], n);
+    }
+
+    for (uint8_t round=0; round<3; round++) {
+        for (uint8_t n=0; n<NUM_NODES; n++) {
+            const uint8_t node_id = t.db.handle_allocation(unique_ids[n]);
+            if (round == 0) {
+                // allocated from the top as prescribed by the standard
+                EXPECT_EQ(125 - n, node_id);
+                node_ids[n] = node_id;
+            } else {
+                // repeated requests get the same node ID
+                EXPECT_EQ(node_ids[n], node_id);
+            }
+        }
+    }
+    for (uint8_t n=0; n<NUM_NODES; n++) {
+        EXPECT_TRUE(t.db.is_registered(node_ids[n]));
+    }
+
+    // nothing reaches storage until the database is flushed
+    EXPECT_EQ(NUM_NODES, t.num_dirty());
+    uint8_t uid_hash[6];
+    t.read_stored(node_ids[0], uid_hash);
+    EXPECT_TRUE(is_zero(uid_hash, sizeof(uid_hash)));
+
+    t.db.flush(true);
+    EXPECT_EQ(0, t.num_dirty());
+    for (uint8_t n=0; n<NUM_NODES; n++) {
+        t.read_stored(node_ids[n], uid_hash);
+        EXPECT_FALSE(is_zero(uid_hash, sizeof(uid_hash)));
+    }
+
+    // a fresh database sees the same registrations and does not
+    // rewrite them
+    static AP_DroneCAN_DNA_Server_Test t2;
+    t2.db.init(&t2.storage);
+    for (uint8_t n=0; n<NUM_NODES; n++) {
+        EXPECT_EQ(node_ids[n], t2.db.handle_allocation(unique_ids[n]));
+    }
+    EXPECT_EQ(0, t2.num_dirty());
+    EXPECT_FALSE(t2.db.is_registered(node_ids[NUM_NODES-1] - 1));
+
+    t.db.reset();
+}
+
+TEST(AP_DroneCAN_DNA_Server, NodeInfo)
+{
+    static AP_DroneCAN_DNA_Server_Test t;
+    t.db.init(&t.storage);
+    t.db.reset();
+
+    uint8_t uid_a[16], uid_b[16];
+    make_unique_id(uid_a, 1);
+    make_unique_id(uid_b, 2);
+
+    // a node with a static node ID is registered from its node info
+    EXPECT_FALSE(t.db.handle_node_info(10, uid_a));
+    EXPECT_TRUE(t.db.is_registered(10));
+    EXPECT_FALSE(t.db.handle_node_info(10, uid_a));
+
+    // a different node with the same node ID is a duplicate
+    EXPECT_TRUE(t.db.handle_node_info(10, uid_b));
+
+    // moving a node to a new node ID drops the old registration
+    EXPECT_FALSE(t.db.handle_node_info(20, uid_a));
+    EXPECT_FALSE(t.db.is_registered(10));
+    EXPECT_TRUE(t.db.is_registered(20));
+
+    // deleting and recreating node 10 leaves a single dirty record
+    t.db.flush(true);
+    EXPECT_EQ(0, t.num_dirty());
+    EXPECT_FALSE(t.db.handle_node_info(10, uid_b));
+    EXPECT_EQ(1, t.num_dirty());
+    EXPECT_EQ(10, t.db.handle_allocation(uid_b));
+    EXPECT_EQ(1, t.num_dirty());
+
+    t.db.reset();
+}
+
+#endif // HAL_ENABLE_DRONECAN_DRIVERS
+
+AP_GTEST_MAIN()
@@ -41,6 +41,13 @@ const AP_Param::GroupInfo AP_ESC_Telem::var_info[] = {
     // @Range: 0 31
     // @User: Standard
     AP_GROUPINFO("_MAV_OFS", 1, AP_ESC_Telem, mavlink_offset, 0),
+
+    // @Param: _OPTIONS
+    // @DisplayName: ESC Telemetry options
+    // @Description: Options for ESC telemetry. Log RPM history writes the RPM samples received to the ESCR log message in batches, for checking the harmonic notch tracking. Only the last 7 samples are kept between log updates, so at telemetry rates above 7 times the logging loop rate some samples are not logged
+    // @Bitmask: 0:Log RPM history
+    // @User: Advanced
+    AP_GROUPINFO("_OPTIONS", 2, AP_ESC_Telem, options, 0),
     
     AP_GROUPEND
 };
@@ -100,6 +107,24 @@ uint8_t AP_ESC_Telem::get_motor_frequencies_hz(uint8_t nfreqs, float* freqs) con
     return MIN(valid_escs, nfreqs);
 }
 
+// return all the motor frequencies in Hz at the time of a gyro sample for dynamic filtering
+uint8_t AP_ESC_Telem::get_motor_frequencies_hz_at(uint32_t time_us, uint8_t nfreqs, float* freqs) const
+{
+    uint8_t valid_escs = 0;
+
+    for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS && valid_escs < nfreqs; i++) {
+        float rpm;
+        if (get_rpm_at(i, time_us, rpm)) {
+            freqs[valid_escs++] = rpm * (1.0f / 60.0f);
+        } else if (was_rpm_data_ever_reported(_rpm_data[i])) {
+            // as get_motor_frequencies_hz(), keep ESCs that have gone quiet
+            freqs[valid_escs++] = 0.0f;
+        }
+    }
+
+    return MIN(valid_escs, nfreqs);
+}
+
 // get mask of ESCs that sent valid telemetry and/or rpm data in the last
 // ESC_TELEM_DATA_TIMEOUT_MS/ESC_RPM_DATA_TIMEOUT_US
 uint32_t AP_ESC_Telem::get_active_esc_mask() const {
@@ -226,6 +251,67 @@ bool AP_ESC_Telem::get_raw_rpm(uint8_t esc_index, float& rpm) const
     return true;
 }
 
+// get an individual ESC's rpm at a given time, interpolated from the rpm history
+bool AP_ESC_Telem::get_rpm_at(uint8_t esc_index, uint32_t time_us, float& rpm) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS || !_rpm_data[esc_index].data_valid) {
+        return false;
+    }
+
+    // copy the newest samples, newest first. The oldest slot is skipped
+    // as it is the next one update_rpm() will overwrite
+    const volatile RpmHistory &history = _rpm_history[esc_index];
+    const uint32_t count = history.count;
+    if (count == 0) {
+        return false;
+    }
+    uint8_t n = MIN(count, uint32_t(ESC_TELEM_RPM_HISTORY_LEN - 1));
+    RpmSample samples[ESC_TELEM_RPM_HISTORY_LEN];
+    for (uint8_t i = 0; i < n; i++) {
+        const volatile RpmSample &sample = history.samples[(count - 1 - i) % ESC_TELEM_RPM_HISTORY_LEN];
+        samples[i].time_us = sample.time_us;
+        samples[i].rpm = sample.rpm;
+    }
+    // each sample added while we copied overwrote one more of the oldest
+    // slots, and the slot after that may be half written. Drop those
+    const uint32_t added = history.count - count;
+    if (added >= ESC_TELEM_RPM_HISTORY_LEN - 1) {
+        return get_rpm(esc_index, rpm);
+    }
+    n = MIN(n, uint8_t(ESC_TELEM_RPM_HISTORY_LEN - 1 - added));
+
+    // look up one sample interval before the requested time, which is
+    // what the slew in get_rpm() does, but using the real sample times
+    uint32_t lookup_us = time_us;
+    if (n > 1) {
+        lookup_us -= samples[0].time_us - samples[1].time_us;
+    }
+    if (int32_t(lookup_us - samples[0].time_us) >= 0) {
+        rpm = samples[0].rpm;
+    } else {
+        // older than the history, use the oldest sample we have
+        rpm = samples[n-1].rpm;
+        for (uint8_t i = 1; i < n; i++) {
+            const RpmSample &newer = samples[i-1];
+            const RpmSample &older = samples[i];
+            if (int32_t(lookup_us - older.time_us) >= 0) {
+                const uint32_t span_us = newer.time_us - older.time_us;
+                const float frac = span_us > 0 ? float(lookup_us - older.time_us) / span_us : 1.0f;
+                rpm = older.rpm + (newer.rpm - older.rpm) * frac;
+                break;
+            }
+        }
+    }
+
+#if AP_SCRIPTING_ENABLED
+    if ((1U<<esc_index) & rpm_scale_mask) {
+        rpm *= rpm_scale_factor[esc_index];
+    }
+#endif
+
+    return true;
+}
+
 // get an individual ESC's temperature in centi-degrees if available, returns true on success
 bool AP_ESC_Telem::get_temperature(uint8_t esc_index, int16_t& temp) const
 {
@@ -604,6 +690,14 @@ void AP_ESC_Telem::update_rpm(const uint8_t esc_index, const float new_rpm, cons
     rpmdata.error_rate = error_rate;
     rpmdata.data_valid = true;
 
+    // the count is advanced after the sample is written so readers
+    // never see a partly written sample as the newest
+    volatile RpmHistory &history = _rpm_history[esc_index];
+    volatile RpmSample &sample = history.samples[history.count % ESC_TELEM_RPM_HISTORY_LEN];
+    sample.time_us = now;
+    sample.rpm = new_rpm;
+    history.count = history.count + 1;
+
 #ifdef ESC_TELEM_DEBUG
     hal.console->printf("RPM: rate=%.1fhz, rpm=%f)\n", rpmdata.update_rate_hz, new_rpm);
 #endif
@@ -792,6 +886,9 @@ void AP_ESC_Telem::update()
                 }
 #endif // AP_EXTENDED_DSHOT_TELEM_V2_ENABLED
             }
+            if (option_is_set(Options::LogRpmHistory)) {
+                write_rpm_history_log(i);
+            }
         }
     }
 #endif  // HAL_LOGGING_ENABLED
@@ -813,6 +910,51 @@ void AP_ESC_Telem::update()
     }
 }
 
+#if HAL_LOGGING_ENABLED
+// write the rpm samples received since the last call, up to 8 per
+// message. Only the last ESC_TELEM_RPM_HISTORY_LEN-1 samples are kept, so
+// at telemetry rates above that many per update() call (700Hz with an
+// update() rate of 100Hz) the samples in between are not logged
+void AP_ESC_Telem::write_rpm_history_log(uint8_t esc_index)
+{
+    const volatile RpmHistory &history = _rpm_history[esc_index];
+    const uint32_t count = history.count;
+    uint32_t next = MAX(_rpm_history_logged[esc_index], count - MIN(count, uint32_t(ESC_TELEM_RPM_HISTORY_LEN - 1)));
+
+    struct log_EscRpm pkt {
+        LOG_PACKET_HEADER_INIT(uint8_t(LOG_ESCR_MSG)),
+        time_us     : 0,
+        instance    : esc_index,
+    };
+    const uint8_t max_batch = ARRAY_SIZE(pkt.rpm);
+    while (next != count) {
+        const uint8_t n = MIN(count - next, uint32_t(max_batch));
+        uint32_t first_us = 0;
+        uint32_t last_us = 0;
+        for (uint8_t i = 0; i < max_batch; i++) {
+            if (i >= n) {
+                pkt.rpm[i] = AP::logger().quiet_nanf();
+                continue;
+            }
+            const volatile RpmSample &sample = history.samples[(next + i) % ESC_TELEM_RPM_HISTORY_LEN];
+            pkt.rpm[i] = sample.rpm;
+            last_us = sample.time_us;
+            if (i == 0) {
+                first_us = last_us;
+            }
+        }
+        // sample times are on the 32 bit clock, place the batch relative to now
+        const uint64_t now_us64 = AP_HAL::micros64();
+        pkt.time_us = now_us64 - MIN(uint64_t(AP_HAL::micros() - first_us), now_us64);
+        pkt.count = n;
+        pkt.interval_us = n > 1 ? MIN((last_us - first_us) / (n - 1), uint32_t(UINT16_MAX)) : 0;
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+        next += n;
+    }
+    _rpm_history_logged[esc_index] = count;
+}
+#endif  // HAL_LOGGING_ENABLED
+
 // NOTE: This function should only be used to check timeouts other than 
 // ESC_RPM_DATA_TIMEOUT_US. Timeouts equal to ESC_RPM_DATA_TIMEOUT_US should
 // use RpmData::data_valid, which is cheaper and achieves the same result.
@@ -15,6 +15,11 @@ static_assert(ESC_TELEM_MAX_ESCS > 0, "Cannot have 0 ESC telemetry instances");
 #define ESC_TELEM_DATA_TIMEOUT_MS 5000UL
 #define ESC_RPM_DATA_TIMEOUT_US 1000000UL
 
+// number of timestamped rpm samples kept per ESC for interpolation
+#ifndef ESC_TELEM_RPM_HISTORY_LEN
+    #define ESC_TELEM_RPM_HISTORY_LEN 8
+#endif
+
 class AP_ESC_Telem {
 public:
     friend class AP_ESC_Telem_Backend;
@@ -34,6 +39,11 @@ public:
     // get an individual ESC's raw rpm if available
     bool get_raw_rpm(uint8_t esc_index, float& rpm) const;
 
+    // get an individual ESC's rpm at a given time, interpolated from the
+    // recent samples. Like get_rpm() this lags by one sample interval so
+    // that the result moves smoothly between samples
+    bool get_rpm_at(uint8_t esc_index, uint32_t time_us, float& rpm) const;
+
     // get raw telemetry data, used by IOMCU
     const volatile AP_ESC_Telem_Backend::TelemetryData& get_telem_data(uint8_t esc_index) const {
         return _telem_data[esc_index];
@@ -92,6 +102,9 @@ public:
     // return all of the motor frequencies in Hz for dynamic filtering
     uint8_t get_motor_frequencies_hz(uint8_t nfreqs, float* freqs) const;
 
+    // return all of the motor frequencies in Hz at the time of a gyro sample for dynamic filtering
+    uint8_t get_motor_frequencies_hz_at(uint32_t time_us, uint8_t nfreqs, float* freqs) const;
+
     // get the number of ESCs that sent valid telemetry data in the last ESC_TELEM_DATA_TIMEOUT_MS
     uint8_t get_num_active_escs() const;
 
@@ -143,8 +156,25 @@ private:
     static uint16_t merge_edt2_stress(uint16_t old_stress, uint16_t new_stress);
 #endif
 
+    // write batches of rpm samples received since the last call to the log
+    void write_rpm_history_log(uint8_t esc_index);
+
     // rpm data
     volatile AP_ESC_Telem_Backend::RpmData _rpm_data[ESC_TELEM_MAX_ESCS];
+
+    // history of rpm samples, written by update_rpm() and read without
+    // locking. count is the total number of samples written, the next
+    // sample goes in samples[count % ESC_TELEM_RPM_HISTORY_LEN]
+    struct RpmSample {
+        uint32_t time_us;
+        float rpm;
+    };
+    struct RpmHistory {
+        RpmSample samples[ESC_TELEM_RPM_HISTORY_LEN];
+        uint32_t count;
+    };
+    volatile RpmHistory _rpm_history[ESC_TELEM_MAX_ESCS];
+    uint32_t _rpm_history_logged[ESC_TELEM_MAX_ESCS];
     // telemetry data
     volatile AP_ESC_Telem_Backend::TelemetryData _telem_data[ESC_TELEM_MAX_ESCS];
 
@@ -162,6 +192,14 @@ private:
 
     AP_Int8 mavlink_offset;
 
+    enum class Options : uint8_t {
+        LogRpmHistory = (1U<<0),
+    };
+    AP_Int8 options;
+    bool option_is_set(Options option) const {
+        return (uint8_t(options.get()) & uint8_t(option)) != 0;
+    }
+
     static AP_ESC_Telem *_singleton;
 };
 
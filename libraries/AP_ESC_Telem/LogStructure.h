@@ -5,7 +5,8 @@
 
 #define LOG_IDS_FROM_ESC_TELEM                  \
     LOG_ESC_MSG,                                \
-    LOG_EDT2_MSG
+    LOG_EDT2_MSG,                               \
+    LOG_ESCR_MSG
 
 // @LoggerMessage: ESC
 // @Description: Feedback received from ESCs
@@ -33,6 +34,29 @@ struct PACKED log_Esc {
     float error_rate;
 };
 
+// @LoggerMessage: ESCR
+// @Description: Batch of RPM samples received from an ESC, oldest first. At telemetry rates above 7 samples per logging loop some samples are skipped
+// @Field: TimeUS: time the first sample was received
+// @Field: Instance: ESC instance number
+// @Field: N: number of samples in this batch
+// @Field: Int: average interval between samples
+// @Field: R0: first rpm sample
+// @Field: R1: second rpm sample
+// @Field: R2: third rpm sample
+// @Field: R3: fourth rpm sample
+// @Field: R4: fifth rpm sample
+// @Field: R5: sixth rpm sample
+// @Field: R6: seventh rpm sample
+// @Field: R7: eighth rpm sample
+struct PACKED log_EscRpm {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint8_t count;
+    uint16_t interval_us;
+    float rpm[8];
+};
+
 enum class log_Edt2_Status : uint8_t {
     HAS_STRESS_DATA = 1U<<0, // true if the message contains up-to-date stress data
     HAS_STATUS_DATA = 1U<<1, // true if the message contains up-to-date status data
@@ -64,7 +88,9 @@ struct PACKED log_Edt2 {
     { LOG_ESC_MSG, sizeof(log_Esc), \
       "ESC",  "QBffffcfcf", "TimeUS,Instance,RPM,RawRPM,Volt,Curr,Temp,CTot,MotTemp,Err", "s#qqvAOaO%", "F-00--BCB-" , true }, \
     { LOG_EDT2_MSG, sizeof(log_Edt2), \
-      "EDT2",  "QBBBB", "TimeUS,Instance,Stress,MaxStress,Status", "s#---", "F----" , true },
+      "EDT2",  "QBBBB", "TimeUS,Instance,Stress,MaxStress,Status", "s#---", "F----" , true }, \
+    { LOG_ESCR_MSG, sizeof(log_EscRpm), \
+      "ESCR",  "QBBHffffffff", "TimeUS,Instance,N,Int,R0,R1,R2,R3,R4,R5,R6,R7", "s#-sqqqqqqqq", "F--F00000000" , true },
 #else
 #define LOG_STRUCTURE_FROM_ESC_TELEM
 #endif
@@ -26,6 +26,7 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Scripting/AP_Scripting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -55,6 +56,9 @@ static const SysFileList sysfs_file_list[] = {
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     {"flash.bin"},
 #endif
+#if AP_SCRIPTING_PROFILER_ENABLED
+    {"lua_profile.txt"},
+#endif
 };
 
 int8_t AP_Filesystem_Sys::file_in_sysfs(const char *fname) {
@@ -137,6 +141,14 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
             hal.can[can_stats_num]->get_stats(*r.str);
         }
     }
+#endif
+#if AP_SCRIPTING_PROFILER_ENABLED
+    if (strcmp(fname, "lua_profile.txt") == 0) {
+        AP_Scripting *scripting = AP_Scripting::get_singleton();
+        if (scripting != nullptr) {
+            scripting->profile_info(*r.str);
+        }
+    }
 #endif
     if (strcmp(fname, "persistent.parm") == 0) {
         hal.util->load_persistent_params(*r.str);
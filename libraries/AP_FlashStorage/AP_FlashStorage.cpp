@@ -109,6 +109,7 @@ bool AP_FlashStorage::init(void)
     // clear any write error
     write_error = false;
     reserved_space = 0;
+    compacting = false;
     
     // if the first sector is full then write out all data so we can erase it
     if (states[first_sector] == SECTOR_STATE_FULL) {
@@ -161,14 +162,17 @@ bool AP_FlashStorage::protected_switch_full_sector(void)
     // clear any write error
     write_error = false;
     reserved_space = 0;
-    
-    if (!write_all()) {
+
+    // anything background_compact() has already copied does not
+    // need writing again
+    if (!write_all(compacting ? compact_ofs : 0)) {
         return false;
     }
 
     if (!erase_sector(current_sector ^ 1, true)) {
         return false;
     }
+    compacting = false;
 
     return switch_sectors();
 }
@@ -263,10 +267,14 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
  */
 bool AP_FlashStorage::load_sector(uint8_t sector)
 {
+    LoadChunk chunk;
+    chunk.ofs = 0;
+    chunk.len = 0;
+
     uint32_t ofs = sizeof(sector_header);
     while (ofs < flash_sector_size - sizeof(struct block_header)) {
         struct block_header header;
-        if (!flash_read(sector, ofs, (uint8_t *)&header, sizeof(header))) {
+        if (!chunk_read(chunk, sector, ofs, (uint8_t *)&header, sizeof(header))) {
             return false;
         }
         enum BlockState state = (enum BlockState)header.state;
@@ -299,7 +307,7 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
                 // the data is invalid (out of range)
                 return false;
             }
-            if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
+            if (!chunk_read(chunk, sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
                 return false;
             }
             //debug("read at %u for %u\n", block_ofs, block_nbytes);
@@ -322,6 +330,28 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
     return true;
 }
 
+/*
+  read from a sector, refilling the chunk buffer when the data is not
+  already in it. Reading a sector one block header at a time makes
+  init() slow on boards where each flash read has a high fixed cost
+ */
+bool AP_FlashStorage::chunk_read(LoadChunk &chunk, uint8_t sector, uint32_t ofs, uint8_t *data, uint16_t length)
+{
+    if (ofs < chunk.ofs || ofs + length > chunk.ofs + chunk.len) {
+        const uint32_t len = MIN(uint32_t(load_chunk_size), flash_sector_size - ofs);
+        if (len < length) {
+            return flash_read(sector, ofs, data, length);
+        }
+        if (!flash_read(sector, ofs, chunk.data, len)) {
+            return false;
+        }
+        chunk.ofs = ofs;
+        chunk.len = len;
+    }
+    memcpy(data, &chunk.data[ofs - chunk.ofs], length);
+    return true;
+}
+
 /*
   erase one sector
  */
@@ -344,6 +374,8 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    reserved_space = 0;
+    compacting = false;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
@@ -362,13 +394,13 @@ bool AP_FlashStorage::erase_all(void)
 }
 
 /*
-  write all of mem_buffer to current sector
+  write all of mem_buffer from start_ofs to current sector
  */
-bool AP_FlashStorage::write_all()
+bool AP_FlashStorage::write_all(uint16_t start_ofs)
 {
-    debug("write_all to sector %u at %u with reserved_space=%u\n",
-           current_sector, write_offset, reserved_space);
-    for (uint16_t ofs=0; ofs<storage_size; ofs += max_write) {
+    debug("write_all to sector %u at %u from %u with reserved_space=%u\n",
+           current_sector, write_offset, start_ofs, reserved_space);
+    for (uint16_t ofs=start_ofs; ofs<storage_size; ofs += max_write) {
         // local variable needed to overcome problem with MIN() macro and -O0
         const uint8_t max_write_local = max_write;
         uint8_t n = MIN(max_write_local, storage_size-ofs);
@@ -395,7 +427,7 @@ bool AP_FlashStorage::all_zero(uint16_t ofs, uint16_t size)
 // switch to next sector for writing
 bool AP_FlashStorage::switch_sectors(void)
 {
-    if (reserved_space != 0) {
+    if (compacting) {
         // other sector is already full
         debug("both sectors are full\n");
         return false;
@@ -439,13 +471,61 @@ bool AP_FlashStorage::switch_sectors(void)
     current_sector = new_sector;
         
     // we need to reserve some space in next sector to ensure we can successfully do a
-    // full write out on init()
+    // full write out on init() or in background_compact()
     reserved_space = reserve_size;
+    compacting = true;
+    compact_ofs = 0;
     
     write_offset = sizeof(header);
     return true;    
 }
 
+/*
+  copy the data still only held in the full sector into the current
+  sector, one block per call to keep latency down, then erase the full
+  sector once allowed. After this the current sector holds a full
+  image of storage, so a later switch_sectors() needs no erase and
+  init() has only one sector to load
+ */
+void AP_FlashStorage::background_compact(void)
+{
+    if (!compacting || write_error) {
+        return;
+    }
+
+    while (compact_ofs < storage_size) {
+        // local variable needed to overcome problem with MIN() macro and -O0
+        const uint8_t max_write_local = max_write;
+        const uint8_t n = MIN(max_write_local, storage_size-compact_ofs);
+        if (all_zero(compact_ofs, n)) {
+            compact_ofs += n;
+            continue;
+        }
+        // the reserve stays untouched so init() can still write
+        // everything out if we lose power before the erase. If the
+        // copy does not fit beside it then switch_full_sector() will
+        // finish the job
+        const uint32_t space_available = flash_sector_size - write_offset;
+        if (space_available < sizeof(struct block_header) + max_write + reserved_space) {
+            return;
+        }
+        if (write(compact_ofs, n)) {
+            compact_ofs += n;
+        }
+        return;
+    }
+
+    if (!flash_erase_ok()) {
+        return;
+    }
+    debug("erasing compacted sector %u\n", current_sector ^ 1);
+    if (!erase_sector(current_sector ^ 1, true)) {
+        return;
+    }
+    reserved_space = 0;
+    compacting = false;
+}
+
 /*
   re-initialise, using current mem_buffer
  */
@@ -19,12 +19,20 @@
   backend for any HAL. The basic methodology is to use a log based
   storage system over two flash sectors. Key design elements:
 
-  - erase of sectors only called on init, as erase will lock the flash
-    and prevent code execution
+  - erase of sectors only called on init or when the caller says
+    erasing is OK, as erase will lock the flash and prevent code
+    execution
 
   - write using log based system
 
-  - read requires scan of all log elements. This is expected to be called rarely
+  - read requires scan of all log elements. This is expected to be
+    called rarely, and is done in chunks to keep the number of flash
+    reads down
+
+  - after switching sectors the live data is copied to the new sector
+    in small steps by background_compact(), so the new sector starts
+    with a full image of storage and the old sector can be erased
+    without a long write_all() while the CPU is stalled
 
   - assumes flash that erases to 0xFF and where writing can only clear
     bits, not set them
@@ -130,6 +138,11 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // copy live data out of a full sector a block at a time, then
+    // erase it once flash_erase_ok() allows. Should be called
+    // regularly from the same thread as write() when it is idle
+    void background_compact(void);
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -146,6 +159,11 @@ private:
     uint32_t reserved_space;
     bool write_error;
 
+    // true while the other sector is full and has not been erased
+    bool compacting;
+    // next offset in mem_buffer to be copied by background_compact()
+    uint16_t compact_ofs;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
     static const uint32_t signature = 0x51685B;
@@ -216,18 +234,29 @@ private:
 
     // amount of space needed to write full storage
     static const uint32_t reserve_size = (storage_size / max_write) * (sizeof(block_header) + max_write) + max_write;
+
+    // bytes read from flash at a time when loading a sector
+    static const uint16_t load_chunk_size = 256;
+    struct LoadChunk {
+        uint32_t ofs;
+        uint16_t len;
+        uint8_t data[load_chunk_size];
+    };
         
     // load data from a sector
     bool load_sector(uint8_t sector) WARN_IF_UNUSED;
 
+    // read from a sector through a chunk buffer
+    bool chunk_read(LoadChunk &chunk, uint8_t sector, uint32_t ofs, uint8_t *data, uint16_t length) WARN_IF_UNUSED;
+
     // erase a sector and write header
     bool erase_sector(uint8_t sector, bool mark_available) WARN_IF_UNUSED;
 
     // erase all sectors and reset
     bool erase_all() WARN_IF_UNUSED;
 
-    // write all of mem_buffer to current sector
-    bool write_all() WARN_IF_UNUSED;
+    // write all of mem_buffer from start_ofs to current sector
+    bool write_all(uint16_t start_ofs=0) WARN_IF_UNUSED;
 
     // return true if all bytes are zero
     bool all_zero(uint16_t ofs, uint16_t size) WARN_IF_UNUSED;
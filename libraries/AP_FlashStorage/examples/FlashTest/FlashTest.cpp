@@ -40,7 +40,25 @@ private:
     // write to storage and mem_mirror
     void write(uint16_t offset, const uint8_t *data, uint16_t length);
 
+    // retry failed writes, as the HAL does for dirty lines
+    void retry_writes(void);
+
+    // re-init from flash as after a power cycle, reporting mount cost
+    void reinit(const char *name);
+
     bool erase_ok;
+
+    // range covering writes that failed
+    uint16_t retry_start;
+    uint16_t retry_end;
+
+    // flash activity, for write amplification and mount cost
+    struct {
+        uint64_t bytes_requested;
+        uint64_t bytes_written;
+        uint32_t reads;
+        uint32_t erases;
+    } stats;
 };
 
 bool FlashTest::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length)
@@ -54,6 +72,7 @@ bool FlashTest::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data
                       (unsigned)offset,
                       (unsigned)length);
     }
+    stats.bytes_written += length;
     uint8_t *b = &flash[sector][offset];
     if ((offset & 1) || (length & 1)) {
         AP_HAL::panic("FATAL: invalid write at %u:%u len=%u",
@@ -98,6 +117,7 @@ bool FlashTest::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint1
                       (unsigned)offset,
                       (unsigned)length);
     }
+    stats.reads++;
     memcpy(data, &flash[sector][offset], length);
     return true;
 }
@@ -107,6 +127,7 @@ bool FlashTest::flash_erase(uint8_t sector)
     if (sector > 1) {
         AP_HAL::panic("FATAL: erase sector %u", (unsigned)sector);
     }
+    stats.erases++;
     memset(&flash[sector][0], 0xFF, flash_sector_size);
     return true;
 }
@@ -124,6 +145,44 @@ void FlashTest::write(uint16_t offset, const uint8_t *data, uint16_t length)
         if (erase_ok) {
             printf("Failed to write at %u for %u\n", offset, length);
         }
+        if (retry_end == retry_start) {
+            retry_start = offset;
+            retry_end = offset + length;
+        } else {
+            retry_start = MIN(retry_start, offset);
+            retry_end = MAX(retry_end, uint16_t(offset + length));
+        }
+        return;
+    }
+    stats.bytes_requested += length;
+}
+
+void FlashTest::retry_writes(void)
+{
+    if (retry_end != retry_start &&
+        storage.write(retry_start, retry_end - retry_start)) {
+        stats.bytes_requested += retry_end - retry_start;
+        retry_start = retry_end = 0;
+    }
+}
+
+void FlashTest::reinit(const char *name)
+{
+    memset(mem_buffer, 0, sizeof(mem_buffer));
+    const uint32_t reads0 = stats.reads;
+    const uint32_t erases0 = stats.erases;
+    const uint64_t t0 = AP_HAL::micros64();
+    if (!storage.init()) {
+        AP_HAL::panic("Failed %s init()", name);
+    }
+    const uint64_t t1 = AP_HAL::micros64();
+    printf("%s: mount %u us, %u reads, %u erases\n",
+           name,
+           unsigned(t1 - t0),
+           unsigned(stats.reads - reads0),
+           unsigned(stats.erases - erases0));
+    if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
+        AP_HAL::panic("FATAL: data mis-match after %s init", name);
     }
 }
 
@@ -146,6 +205,8 @@ void FlashTest::loop(void)
         AP_HAL::panic("Failed first init()");
     }
 
+    bool power_cycle = false;
+
     // fill with 10k random writes
     for (uint32_t i=0; i<5000000; i++) {
         uint16_t ofs = get_random16() % sizeof(mem_buffer);
@@ -158,33 +219,57 @@ void FlashTest::loop(void)
 
         erase_ok = (i % 1000 == 0);
         write(ofs, data, length);
+        if (erase_ok) {
+            retry_writes();
+        }
+
+        // the HAL compacts when it has no dirty lines
+        if (i % 4 == 0) {
+            storage.background_compact();
+        }
 
         if (erase_ok) {
             if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
                 AP_HAL::panic("FATAL: data mis-match at i=%u", (unsigned)i);
             }
         }
+
+        // power cycle part way through, whatever state the
+        // sectors are in
+        if (i % 500000 == 250000) {
+            power_cycle = true;
+        }
+        if (power_cycle && retry_end == retry_start) {
+            power_cycle = false;
+            reinit("power cycle");
+        }
     }
 
+    printf("write amplification %.2f (%llu bytes written for %llu), %u erases\n",
+           double(stats.bytes_written) / double(MAX(stats.bytes_requested, 1ULL)),
+           (unsigned long long)stats.bytes_written,
+           (unsigned long long)stats.bytes_requested,
+           unsigned(stats.erases));
+
     // force final write to allow for flush with erase_ok
     erase_ok = true;
     uint8_t b = 42;
     write(37, &b, 1);
+    retry_writes();
     
     if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
         AP_HAL::panic("FATAL: data mis-match before re-init");
     }
     
     // re-init
-    printf("re-init\n");
-    memset(mem_buffer, 0, sizeof(mem_buffer));
-    if (!storage.init()) {
-        AP_HAL::panic("Failed second init()");
-    }
+    reinit("final");
 
-    if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
-        AP_HAL::panic("FATAL: data mis-match");
+    // idle until the full sector is erased, then mount again. This
+    // is the usual state at boot
+    for (uint16_t i=0; i<AP_FlashStorage::storage_size; i++) {
+        storage.background_compact();
     }
+    reinit("compacted");
     while (true) {
         hal.console->printf("TEST PASSED");
         hal.scheduler->delay(20000);
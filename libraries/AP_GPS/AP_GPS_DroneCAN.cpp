@@ -548,8 +548,12 @@ void AP_GPS_DroneCAN::handle_moving_baseline_msg(const ardupilot_gnss_MovingBase
     if (rtcm3_parser == nullptr) {
         return;
     }
-    for (int i=0; i < msg.data.len; i++) {
-        rtcm3_parser->read(msg.data.data[i]);
+    const uint8_t *data = msg.data.data;
+    uint16_t len = msg.data.len;
+    while (len > 0) {
+        const uint16_t n = rtcm3_parser->read(data, len);
+        data += n;
+        len -= n;
     }
 }
 
@@ -58,19 +58,25 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
     bool parsed = false;
 
     send_config();
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
+    uint32_t numc = port->available();
+    while (numc > 0) {
+        uint8_t buf[64];
+        const ssize_t n = port->read(buf, MIN(numc, sizeof(buf)));
+        if (n <= 0) {
+            break;
+        }
+        numc -= n;
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data((const uint8_t *)&c, 1);
+        log_data(buf, n);
 #endif
-        if (_decode(c)) {
-            parsed = true;
+        for (ssize_t i = 0; i < n; i++) {
+            if (_decode(buf[i])) {
+                parsed = true;
+            }
         }
     }
     return parsed;
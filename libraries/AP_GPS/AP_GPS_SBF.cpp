@@ -89,12 +89,19 @@ AP_GPS_SBF::read(void)
 {
     bool ret = false;
     uint32_t available_bytes = port->available();
-    for (uint32_t i = 0; i < available_bytes; i++) {
-        uint8_t temp = port->read();
+    while (available_bytes > 0) {
+        uint8_t buf[64];
+        const ssize_t n = port->read(buf, MIN(available_bytes, sizeof(buf)));
+        if (n <= 0) {
+            break;
+        }
+        available_bytes -= n;
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&temp, 1);
+        log_data(buf, n);
 #endif
-        ret |= parse(temp);
+        for (ssize_t i = 0; i < n; i++) {
+            ret |= parse(buf[i]);
+        }
     }
 
     const uint32_t now = AP_HAL::millis();
@@ -684,17 +684,28 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        uint8_t data;
-        if (!port->read(data)) {
-            break;
-        }
+    // read the port in blocks. Bytes left in _rx when we stop for a
+    // RTCMv3 packet are parsed on the next call
+    uint16_t numc = MIN(port->available(), 8192U);
+    while (true) {
+        if (_rx.ofs == _rx.len) {
+            if (numc == 0) {
+                break;
+            }
+            const ssize_t n = port->read(_rx.buf, MIN(numc, uint16_t(sizeof(_rx.buf))));
+            if (n <= 0) {
+                break;
+            }
+            numc -= n;
+            _rx.ofs = 0;
+            _rx.len = n;
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
+            log_data(_rx.buf, n);
 #endif
+        }
+
+        // parse the next byte
+        const uint8_t data = _rx.buf[_rx.ofs++];
 
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
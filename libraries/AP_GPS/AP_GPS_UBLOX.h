@@ -771,6 +771,13 @@ private:
     uint8_t         _class;
     bool            _cfg_saved;
 
+    // bytes read from the port and not yet parsed
+    struct {
+        uint8_t buf[64];
+        uint8_t ofs;
+        uint8_t len;
+    } _rx;
+
     uint32_t        _last_vel_time;
     uint32_t        _last_pos_time;
     uint32_t        _last_cfg_sent_time;
@@ -135,6 +135,41 @@ bool RTCM3_Parser::read(uint8_t byte)
     return false;
 }
 
+/*
+  read in a block of bytes, stopping after a full packet. Bytes
+  between packets are skipped and packet bodies are copied in one go,
+  giving the same result as calling read() for each byte
+ */
+uint16_t RTCM3_Parser::read(const uint8_t *bytes, uint16_t len)
+{
+    uint16_t i = 0;
+    while (i < len) {
+        clear_packet();
+
+        if (pkt_bytes == 0) {
+            // skip to the next preamble
+            const uint8_t *p = (const uint8_t *)memchr(&bytes[i], RTCMv3_PREAMBLE, len - i);
+            if (p == nullptr) {
+                return len;
+            }
+            i = p - bytes;
+        } else if (pkt[0] == RTCMv3_PREAMBLE && pkt_len != 0 &&
+                   pkt_len + 6U <= sizeof(pkt) && pkt_bytes + 1U < pkt_len + 6U) {
+            // copy the body, leaving the last byte for read() to parse
+            const uint16_t n = MIN(uint16_t(len - i), uint16_t(pkt_len + 5U - pkt_bytes));
+            memcpy(&pkt[pkt_bytes], &bytes[i], n);
+            pkt_bytes += n;
+            i += n;
+            continue;
+        }
+
+        if (read(bytes[i++])) {
+            return i;
+        }
+    }
+    return len;
+}
+
 #ifdef RTCM_MAIN_TEST
 /*
   parsing test, taking a raw file captured from UART to u-blox F9
@@ -155,11 +190,18 @@ int main(int argc, const char *argv[])
         ::exit(1);
     }
     RTCM3_Parser parser {};
-    uint8_t b;
-    while (::read(fd, &b, 1) == 1) {
-        if (parser.read(b)) {
+    uint8_t buf[256];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+        const uint8_t *b = buf;
+        while (n > 0) {
+            const uint16_t used = parser.read(b, n);
+            b += used;
+            n -= used;
             const uint8_t *bytes;
-            printf("packet len %u ID %u\n", parser.get_len(bytes), parser.get_id());
+            if (parser.get_len(bytes) > 0) {
+                printf("packet len %u ID %u\n", parser.get_len(bytes), parser.get_id());
+            }
         }
     }
     return 0;
@@ -28,6 +28,10 @@ public:
     // process one byte, return true if packet found
     bool read(uint8_t b);
 
+    // process bytes until a packet is found, return the number of
+    // bytes used. Check get_len() for the packet
+    uint16_t read(const uint8_t *bytes, uint16_t len);
+
     // reset internal state
     void reset(void);
 
@@ -0,0 +1,212 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_SBF.h>
+#include <AP_Math/crc.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <stdio.h>
+
+// GPS stream parsing by each serial driver, the argument is the bytes available per read() and 1 is the byte at a time baseline
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+GCS_Dummy _gcs;
+
+static AP_GPS gps;
+static AP_GPS::Params params;
+static AP_GPS::GPS_State gps_state;
+
+// number of fixes in each stream
+static const uint16_t num_fixes = 50;
+
+/*
+  uart replaying a stream, limiting how much is available per read()
+ */
+class UARTDriver_Stream : public AP_HAL::UARTDriver
+{
+public:
+    void set_stream(const uint8_t *_data, uint32_t _len, uint16_t _chunk) {
+        data = _data;
+        len = _len;
+        chunk = _chunk;
+        ofs = 0;
+        limit = 0;
+    }
+    bool done(void) const { return ofs >= len; }
+
+    // make the next chunk of the stream available
+    void next_chunk(void) { limit = MIN(ofs + chunk, len); }
+
+    bool is_initialized() override { return true; }
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 1024; }
+
+protected:
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    size_t _write(const uint8_t *buffer, size_t size) override { return size; }
+    ssize_t _read(uint8_t *buffer, uint16_t count) override {
+        const uint32_t n = MIN(uint32_t(count), limit - ofs);
+        memcpy(buffer, &data[ofs], n);
+        ofs += n;
+        return n;
+    }
+    void _end() override {}
+    void _flush() override {}
+    uint32_t _available() override { return limit - ofs; }
+    bool _discard_input() override {
+        ofs = limit;
+        return true;
+    }
+
+private:
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t ofs;
+    uint32_t limit;
+    uint16_t chunk;
+};
+
+static UARTDriver_Stream uart;
+
+struct Stream {
+    uint8_t data[16384];
+    uint16_t len;
+
+    void add(const uint8_t *bytes, uint16_t n) {
+        memcpy(&data[len], bytes, n);
+        len += n;
+    }
+};
+
+static Stream ubx_stream;
+static Stream nmea_stream;
+static Stream sbf_stream;
+
+// NAV-PVT messages, as a u-blox sends at 10Hz
+static void make_ubx_stream(void)
+{
+    if (ubx_stream.len != 0) {
+        return;
+    }
+    for (uint16_t i=0; i<num_fixes; i++) {
+        uint8_t msg[6+92+2] {};
+        msg[0] = 0xb5;
+        msg[1] = 0x62;
+        msg[2] = 0x01;  // NAV
+        msg[3] = 0x07;  // PVT
+        msg[4] = 92;
+        const uint32_t itow = 100000 + i*100;
+        memcpy(&msg[6], &itow, sizeof(itow));
+        msg[6+20] = 3;      // 3D fix
+        msg[6+21] = 0x01;   // gnssFixOK
+        msg[6+23] = 18;     // numSV
+        uint8_t ck_a = 0, ck_b = 0;
+        for (uint8_t j=2; j<6+92; j++) {
+            ck_b += (ck_a += msg[j]);
+        }
+        msg[6+92] = ck_a;
+        msg[6+92+1] = ck_b;
+        ubx_stream.add(msg, sizeof(msg));
+    }
+}
+
+// GGA and RMC sentences for each fix
+static void make_nmea_stream(void)
+{
+    if (nmea_stream.len != 0) {
+        return;
+    }
+    for (uint16_t i=0; i<num_fixes; i++) {
+        char body[2][100];
+        snprintf(body[0], sizeof(body[0]),
+                 "GPGGA,1235%02u.%02u,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+                 unsigned(i/10), unsigned((i%10)*10));
+        snprintf(body[1], sizeof(body[1]),
+                 "GPRMC,1235%02u.%02u,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W",
+                 unsigned(i/10), unsigned((i%10)*10));
+        for (const char *b : body) {
+            uint8_t cksum = 0;
+            for (const char *p = b; *p; p++) {
+                cksum ^= *p;
+            }
+            char sentence[120];
+            const int n = snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", b, cksum);
+            nmea_stream.add((const uint8_t *)sentence, n);
+        }
+    }
+}
+
+// PVTGeodetic blocks
+static void make_sbf_stream(void)
+{
+    if (sbf_stream.len != 0) {
+        return;
+    }
+    for (uint16_t i=0; i<num_fixes; i++) {
+        uint8_t msg[96] {};
+        msg[0] = '$';
+        msg[1] = '@';
+        const uint16_t blockid = 4007 | (2U<<13);
+        const uint16_t length = sizeof(msg);
+        memcpy(&msg[4], &blockid, 2);
+        memcpy(&msg[6], &length, 2);
+        const uint32_t tow = 100000 + i*100;
+        memcpy(&msg[8], &tow, sizeof(tow));
+        msg[8+6] = 4;       // 3D fix, RTK fixed
+        msg[8+66] = 18;     // NrSV
+        const uint16_t crc = crc16_ccitt(&msg[4], sizeof(msg)-4, 0);
+        memcpy(&msg[2], &crc, 2);
+        sbf_stream.add(msg, sizeof(msg));
+    }
+}
+
+/*
+  feed the stream through read(), a chunk at a time as the uart would
+  receive it between updates
+ */
+static void run(benchmark::State& state, AP_GPS_Backend &backend, const Stream &stream)
+{
+    const uint16_t chunk = state.range(0);
+    while (state.KeepRunning()) {
+        uart.set_stream(stream.data, stream.len, chunk);
+        while (!uart.done()) {
+            uart.next_chunk();
+            bool parsed = backend.read();
+            gbenchmark_escape(&parsed);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * stream.len);
+}
+
+static void BM_GPSReadUBLOX(benchmark::State& state)
+{
+    make_ubx_stream();
+    AP_GPS_UBLOX *backend = NEW_NOTHROW AP_GPS_UBLOX(gps, params, gps_state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+    run(state, *backend, ubx_stream);
+    delete backend;
+}
+
+static void BM_GPSReadNMEA(benchmark::State& state)
+{
+    make_nmea_stream();
+    AP_GPS_NMEA *backend = NEW_NOTHROW AP_GPS_NMEA(gps, params, gps_state, &uart);
+    run(state, *backend, nmea_stream);
+    delete backend;
+}
+
+static void BM_GPSReadSBF(benchmark::State& state)
+{
+    make_sbf_stream();
+    AP_GPS_SBF *backend = NEW_NOTHROW AP_GPS_SBF(gps, params, gps_state, &uart);
+    run(state, *backend, sbf_stream);
+    delete backend;
+}
+
+BENCHMARK(BM_GPSReadUBLOX)->Arg(1)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK(BM_GPSReadNMEA)->Arg(1)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK(BM_GPSReadSBF)->Arg(1)->Arg(16)->Arg(64)->Arg(512);
+
+BENCHMARK_MAIN();
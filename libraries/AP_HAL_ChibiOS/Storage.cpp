@@ -251,11 +251,20 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#ifdef STORAGE_FLASH_PAGE
+        if (_initialisedType == StorageBackend::Flash) {
+            // use idle time to finish any sector switch
+            _flash.background_compact();
+        }
+#endif
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    // write out the first dirty line, along with up to
+    // CH_STORAGE_FLUSH_LINES adjacent dirty lines. The last line of a
+    // run is usually still being written to, so it is left for the
+    // next call unless it is the only one. This keeps the latency of
+    // this call low while needing fewer flash blocks and device writes
     uint16_t i;
     for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -266,18 +275,27 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t n = 1;
+    while (n < CH_STORAGE_FLUSH_LINES+1 && i+n < CH_STORAGE_NUM_LINES && _dirty_mask.get(i+n)) {
+        n++;
+    }
+    if (n > 1) {
+        n--;
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*n;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
             write_ok = true;
         }
     }
@@ -285,11 +303,10 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
+        if (AP::FS().write(log_fd, &_buffer[offset], length) != length) {
             return;
         }
         if (AP::FS().fsync(log_fd) != 0) {
@@ -302,7 +319,7 @@ void Storage::_timer_tick(void)
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(i, n)) {
             write_ok = true;
         }
     }
@@ -310,14 +327,16 @@ void Storage::_timer_tick(void)
 
     if (write_ok) {
         WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
+        // while holding the semaphore we check if the copy of each
         // line is different from the original line. If it is
         // different then someone has re-dirtied the line while we
         // were writing it, in which case we should not mark it
         // clean. If it matches then we know we can mark the line as
         // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+        for (uint16_t j=0; j<n; j++) {
+            if (memcmp(&tmpline[CH_STORAGE_LINE_SIZE*j], &_buffer[offset+CH_STORAGE_LINE_SIZE*j], CH_STORAGE_LINE_SIZE) == 0) {
+                _dirty_mask.clear(i+j);
+            }
         }
     }
 }
@@ -345,13 +364,13 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write nlines storage lines starting at line
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t nlines)
 {
 #ifdef STORAGE_FLASH_PAGE
     EXPECT_DELAY_MS(1);
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, nlines*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
@@ -47,6 +47,16 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// maximum number of adjacent dirty lines written together by
+// _timer_tick(), bounding the latency of each call to a 64 byte write
+#ifndef CH_STORAGE_FLUSH_LINES
+#if CH_STORAGE_LINE_SIZE < 64
+#define CH_STORAGE_FLUSH_LINES (64/CH_STORAGE_LINE_SIZE)
+#else
+#define CH_STORAGE_FLUSH_LINES 1
+#endif
+#endif
+
 /*
   on boards with 8k sector sizes we double up to treat pairs of sectors as one
  */
@@ -80,7 +90,7 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_LINE_SIZE*CH_STORAGE_FLUSH_LINES];
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -105,7 +115,7 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t nlines);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
@@ -30,6 +30,12 @@
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// maximum number of adjacent dirty lines written together by
+// _timer_tick(), bounding the latency of each call to a 64 byte write
+#ifndef STORAGE_FLUSH_LINES
+#define STORAGE_FLUSH_LINES (64/STORAGE_LINE_SIZE)
+#endif
+
 class ESP32::Storage : public AP_HAL::Storage
 {
 public:
@@ -65,5 +71,5 @@ private:
                         FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool)};
 
     void _flash_load(void);
-    void _flash_write(uint16_t line);
+    void _flash_write(uint16_t line, uint16_t nlines);
 };
@@ -37,6 +37,8 @@
 #include <sys/time.h>
 #include <net/if.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <time.h>
 #include <cstring>
 #include "Scheduler.h"
 #include <AP_CANManager/AP_CANManager.h>
@@ -124,8 +126,13 @@ int CANIface::_openSocket(const std::string& iface_name)
     // Configure
     {
         const int on = 1;
-        // Timestamping
-        if (setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0) {
+        // Timestamping, using the controller timestamp where the driver
+        // provides one and the kernel receive time otherwise
+        const int ts_flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                             SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        _timestamping = setsockopt(s, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) == 0;
+        if (!_timestamping &&
+            setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0) {
             return -1;
         }
         // Socket loopback
@@ -270,45 +277,80 @@ void CANIface::_pollWrite()
 {
     while (_hasReadyTx()) {
         WITH_SEMAPHORE(sem);
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
+
+        // take as many frames as the socket allowance permits off the
+        // queue, highest priority first
+        CanTxItem batch[CAN_IO_BATCH_SIZE];
+        uint8_t count = 0;
+        const uint64_t curr_time = AP_HAL::micros64();
+        const unsigned allowance = std::min(unsigned(CAN_IO_BATCH_SIZE),
+                                            _max_frames_in_socket_tx_queue - _frames_in_socket_tx_queue);
+        while (count < allowance && !_tx_queue.empty()) {
+            const CanTxItem &tx = _tx_queue.top();
+            if (tx.deadline >= curr_time) {
+                batch[count++] = tx;
+            } else {
+                stats.tx_timedout++;
+            }
+            (void)_tx_queue.pop();
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        const int res = _writeBatch(batch, count);
+        uint8_t sent = 0;
+        if (res > 0) {                        // Transmitted successfully
+            sent = res;
+            for (uint8_t i = 0; i < sent; i++) {
                 _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
+                if (batch[i].loopback) {
+                    _pending_loopback_ids.insert(batch[i].frame.id);
                 }
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_overflow++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_rejected++;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+            stats.tx_success += sent;
+            stats.tx_batches++;
+            stats.last_transmit_us = curr_time;
+        } else if (res == 0) {                // Not transmitted, nor is it an error
+            stats.tx_overflow++;
+        } else {                              // Transmission error, drop the first frame
+            stats.tx_rejected++;
+            sent = 1;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        // frames the socket did not take stay enqueued for the next retry
+        for (uint8_t i = sent; i < count; i++) {
+            _tx_queue.push(batch[i]);
+        }
+        if (sent < count && res >= 0) {
+            break;
+        }
     }
 }
 
 bool CANIface::_pollRead()
 {
+    bool received = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
         iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
+        WITH_SEMAPHORE(sem);
+        const int res = _readBatch();
+        if (res < 0) {
+            stats.rx_errors++;
+            break;
+        }
+        if (res == 0) {
+            break;
+        }
+        stats.rx_batches++;
+        for (uint8_t i = 0; i < res; i++) {
+            CanRxItem rx;
+            bool loopback = false;
+            if (!_parseRx(i, rx, loopback)) {
+                continue;
+            }
             bool accept = true;
             if (loopback) {           // We receive loopback for all CAN frames
                 _confirmSentFrame();
@@ -317,83 +359,165 @@ bool CANIface::_pollRead()
                 stats.tx_confirmed++;
             }
             if (accept) {
-                WITH_SEMAPHORE(sem);
                 _rx_queue.push(rx);
                 stats.rx_received++;
-                return true;
+                received = true;
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            stats.rx_errors++;
+        }
+        if (res < CAN_IO_BATCH_SIZE) {
+            // socket drained
             break;
         }
     }
-    return false;
+    return received;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+/*
+  write a batch of frames with one system call. Returns the number of
+  frames written, 0 if the socket can't take any at the moment or
+  negative on error
+ */
+int CANIface::_writeBatch(const CanTxItem* items, uint8_t count)
 {
     if (_fd < 0) {
         return -1;
     }
     errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
+    can_frame frames[CAN_IO_BATCH_SIZE];
+    iovec iov[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+    for (uint8_t i = 0; i < count; i++) {
+        frames[i] = makeSocketCanFrame(items[i].frame);
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    const int res = sendmmsg(_fd, msgs, count, MSG_DONTWAIT);
     if (res <= 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
-    }
-    if (res != sizeof(sockcan_frame)) {
         return -1;
     }
-    return 1;
+    return res;
 }
 
-
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+/*
+  read up to CAN_IO_BATCH_SIZE frames into _rx_slots with one system
+  call. Returns the number of frames read, 0 if none are waiting or
+  negative on error
+ */
+int CANIface::_readBatch()
 {
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
-    union {
-        uint8_t data[CMSG_SPACE(sizeof(::timeval))];
-        struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
-
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
+    for (uint8_t i = 0; i < CAN_IO_BATCH_SIZE; i++) {
+        RxSlot &slot = _rx_slots[i];
+        slot.iov.iov_base = &slot.frame;
+        slot.iov.iov_len = sizeof(slot.frame);
+        msghdr &msg = _rx_msgs[i].msg_hdr;
+        msg = msghdr();
+        msg.msg_iov = &slot.iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = slot.control;
+        msg.msg_controllen = sizeof(slot.control);
+    }
+
+    const int res = recvmmsg(_fd, _rx_msgs, CAN_IO_BATCH_SIZE, MSG_DONTWAIT, nullptr);
     if (res <= 0) {
         return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
+    return res;
+}
+
+/*
+  convert a received slot to a frame, returns false if it should be
+  ignored
+ */
+bool CANIface::_parseRx(uint8_t index, CanRxItem& rx, bool& loopback)
+{
+    const msghdr &msg = _rx_msgs[index].msg_hdr;
+    const can_frame &sockcan_frame = _rx_slots[index].frame;
+    if (_rx_msgs[index].msg_len != sizeof(sockcan_frame)) {
+        return false;
+    }
     /*
      * Flags
      */
     loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
     if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
+        return false;
     }
 
-    frame = makeUavcanFrame(sockcan_frame);
+    rx.frame = makeUavcanFrame(sockcan_frame);
     /*
      * Timestamp
      */
-    timestamp_us = AP_HAL::micros64();
-    return 1;
+    rx.timestamp_us = _rxTimestamp(msg);
+    return true;
+}
+
+/*
+  return the receive time of a frame on the micros64() time base. The
+  kernel timestamps are in the real time clock domain, so the age of
+  the frame is subtracted from the current time
+ */
+uint64_t CANIface::_rxTimestamp(const msghdr& msg)
+{
+    const uint64_t now_us = AP_HAL::micros64();
+
+    int64_t rx_ns = 0;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(const_cast<msghdr*>(&msg)); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // software, deprecated and raw hardware timestamps
+            timespec ts[3];
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+            const int64_t sw_ns = int64_t(ts[0].tv_sec) * 1000000000LL + ts[0].tv_nsec;
+            const int64_t hw_ns = int64_t(ts[2].tv_sec) * 1000000000LL + ts[2].tv_nsec;
+            rx_ns = sw_ns;
+            if (hw_ns != 0 && sw_ns != 0) {
+                const int64_t offset_ns = sw_ns - hw_ns;
+                if (_hw_offset_window_count == 0 || offset_ns < _hw_offset_window_min_ns) {
+                    _hw_offset_window_min_ns = offset_ns;
+                }
+                if (_hw_offset_ns == 0 || offset_ns < _hw_offset_ns) {
+                    _hw_offset_ns = offset_ns;
+                }
+                // restart the window periodically to follow clock drift
+                if (++_hw_offset_window_count >= 1000) {
+                    _hw_offset_ns = _hw_offset_window_min_ns;
+                    _hw_offset_window_count = 0;
+                }
+                rx_ns = hw_ns + _hw_offset_ns;
+                stats.rx_hw_timestamps++;
+            }
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMP) {
+            timeval tv;
+            memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            rx_ns = int64_t(tv.tv_sec) * 1000000000LL + int64_t(tv.tv_usec) * 1000LL;
+        }
+    }
+    if (rx_ns == 0) {
+        return now_us;
+    }
+
+    timespec now_ts;
+    clock_gettime(CLOCK_REALTIME, &now_ts);
+    const int64_t now_ns = int64_t(now_ts.tv_sec) * 1000000000LL + now_ts.tv_nsec;
+    const int64_t age_us = (now_ns - rx_ns) / 1000;
+    if (age_us < 0 || uint64_t(age_us) > now_us || age_us > 1000000) {
+        // clock stepped or frame is implausibly old
+        return now_us;
+    }
+    return now_us - age_us;
 }
 
 // Might block forever, only to be used for testing
@@ -553,7 +677,10 @@ void CANIface::get_stats(ExpandingString &str)
                "num_tx_poll_req:  %u\n"
                "num_poll_waits:   %u\n"
                "num_poll_tx_events: %u\n"
-               "num_poll_rx_events: %u\n",
+               "num_poll_rx_events: %u\n"
+               "rx_batches:     %u\n"
+               "tx_batches:     %u\n"
+               "rx_hw_timestamps: %u\n",
                stats.tx_requests,
                stats.tx_rejected,
                stats.tx_overflow,
@@ -567,7 +694,10 @@ void CANIface::get_stats(ExpandingString &str)
                stats.num_tx_poll_req,
                stats.num_poll_waits,
                stats.num_poll_tx_events,
-               stats.num_poll_rx_events);
+               stats.num_poll_rx_events,
+               stats.rx_batches,
+               stats.tx_batches,
+               stats.rx_hw_timestamps);
 }
 
 #endif
@@ -33,6 +33,7 @@
 #include <AP_HAL/CANIface.h>
 
 #include <linux/can.h>
+#include <sys/socket.h>
 
 #include <string>
 #include <queue>
@@ -54,11 +55,20 @@ enum class SocketCanError
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
 
+// number of frames moved per recvmmsg/sendmmsg call
+#define CAN_IO_BATCH_SIZE 16
+
+// frames handed to the kernel but not yet confirmed by loopback. The
+// kernel queue is FIFO, so this bounds how long a high priority frame
+// can wait behind lower priority ones. Send batches only fill this
+// allowance, they never extend it
+#define CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE 2
+
 class CANIface: public AP_HAL::CANIface {
 public:
     CANIface(int index)
       : _self_index(index)
-      , _max_frames_in_socket_tx_queue(2)
+      , _max_frames_in_socket_tx_queue(CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE)
       , _frames_in_socket_tx_queue(0)
     { }
 
@@ -120,9 +130,13 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    int _writeBatch(const CanTxItem* items, uint8_t count);
+
+    int _readBatch();
+
+    bool _parseRx(uint8_t index, CanRxItem& rx, bool& loopback);
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    uint64_t _rxTimestamp(const msghdr& msg);
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -163,6 +177,24 @@ private:
     std::unordered_multiset<uint32_t> _pending_loopback_ids;
     std::vector<can_filter> _hw_filters_container;
 
+    // buffers for batched socket I/O
+    struct RxSlot {
+        can_frame frame;
+        alignas(cmsghdr) uint8_t control[CMSG_SPACE(3 * sizeof(::timespec))];
+        iovec iov;
+    } _rx_slots[CAN_IO_BATCH_SIZE];
+    mmsghdr _rx_msgs[CAN_IO_BATCH_SIZE];
+
+    // true if SO_TIMESTAMPING was accepted, otherwise SO_TIMESTAMP is used
+    bool _timestamping;
+
+    // offset from the controller clock to the kernel real time clock,
+    // taken as the minimum over a window of frames as the software
+    // timestamp is always later than the hardware one
+    int64_t _hw_offset_ns;
+    int64_t _hw_offset_window_min_ns;
+    uint16_t _hw_offset_window_count;
+
     struct bus_stats : public AP_HAL::CANIface::bus_stats_t {
         uint32_t tx_confirmed;
         uint32_t num_downs;
@@ -171,6 +203,9 @@ private:
         uint32_t num_poll_waits;
         uint32_t num_poll_tx_events;
         uint32_t num_poll_rx_events;
+        uint32_t rx_batches;
+        uint32_t tx_batches;
+        uint32_t rx_hw_timestamps;
     } stats;
 
 protected:
@@ -138,25 +138,43 @@ void CANIface::_pollWrite()
     if (transport == nullptr) {
         return;
     }
-    while (_hasReadyTx()) {
-        WITH_SEMAPHORE(sem);
-        const CanTxItem tx = *_tx_queue[0];
+    WITH_SEMAPHORE(sem);
+    while (!_tx_queue.is_empty()) {
+        // gather frames still within their deadline from the head of
+        // the queue and hand them to the transport in one go
+        AP_HAL::CANFrame frames[SITL_CAN_IO_BATCH_SIZE];
+        uint16_t count = 0;
+        uint16_t consumed = 0;
         const uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            bool ok = transport->send(tx.frame);
-            if (ok) {
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
+        const uint16_t queued = _tx_queue.available();
+        while (consumed < queued && count < SITL_CAN_IO_BATCH_SIZE) {
+            const CanTxItem &tx = *_tx_queue[consumed];
+            if (tx.deadline >= curr_time) {
+                frames[count++] = tx.frame;
+            } else if (count == 0) {
+                // drop expired frames at the head
+                stats.tx_timedout++;
             } else {
+                // leave it to be dropped at the start of the next batch
                 break;
             }
-        } else {
-            stats.tx_timedout++;
+            consumed++;
+        }
+
+        const uint16_t sent = count > 0 ? transport->send_batch(frames, count) : 0;
+        if (sent > 0) {
+            stats.tx_success += sent;
+            stats.last_transmit_us = curr_time;
         }
 
-        // Removing the frame from the queue
-        IGNORE_RETURN(_tx_queue.pop());
+        // remove the expired frames and the frames sent
+        const uint16_t to_pop = (consumed - count) + sent;
+        for (uint16_t i=0; i<to_pop; i++) {
+            IGNORE_RETURN(_tx_queue.pop());
+        }
+        if (sent < count) {
+            break;
+        }
     }
 }
 
@@ -165,16 +183,25 @@ bool CANIface::_pollRead()
     if (transport == nullptr) {
         return false;
     }
-    CanRxItem rx {};
-    bool ok = transport->receive(rx.frame);
-    if (!ok) {
-        return false;
-    }
-    rx.timestamp_us = AP_HAL::micros64();
     WITH_SEMAPHORE(sem);
-    add_to_rx_queue(rx);
-    stats.rx_received++;
-    return true;
+    bool received = false;
+    while (_rx_queue.space() > 0) {
+        AP_HAL::CANFrame frames[SITL_CAN_IO_BATCH_SIZE];
+        const uint16_t count = transport->receive_batch(frames, MIN(_rx_queue.space(), SITL_CAN_IO_BATCH_SIZE));
+        if (count == 0) {
+            break;
+        }
+        const uint64_t now_us = AP_HAL::micros64();
+        for (uint16_t i=0; i<count; i++) {
+            CanRxItem rx {};
+            rx.frame = frames[i];
+            rx.timestamp_us = now_us;
+            add_to_rx_queue(rx);
+        }
+        stats.rx_received += count;
+        received = true;
+    }
+    return received;
 }
 
 // Might block forever, only to be used for testing
@@ -289,15 +316,19 @@ void CANIface::get_stats(ExpandingString &str)
 {
     str.printf("tx_requests:    %u\n"
                "tx_rejected:    %u\n"
+               "tx_overflow:    %u\n"
                "tx_success:     %u\n"
                "tx_timedout:    %u\n"
                "rx_received:    %u\n"
+               "rx_overflow:    %u\n"
                "rx_errors:      %u\n",
                stats.tx_requests,
                stats.tx_rejected,
+               stats.tx_overflow,
                stats.tx_success,
                stats.tx_timedout,
                stats.rx_received,
+               stats.rx_overflow,
                stats.rx_errors);
 }
 
@@ -28,6 +28,15 @@
 #include <poll.h>
 #include "CAN_Transport.h"
 
+// depth of the transmit and receive queues, enough to absorb a
+// saturated 1Mbit/s bus between scheduler loops
+#ifndef HAL_SITL_CAN_QUEUE_LEN
+#define HAL_SITL_CAN_QUEUE_LEN 1024
+#endif
+
+// frames moved between the queues and the transport per call
+#define SITL_CAN_IO_BATCH_SIZE 32
+
 namespace HALSITL {
 
 class CANIface: public AP_HAL::CANIface {
@@ -126,8 +135,8 @@ private:
     AP_HAL::BinarySemaphore *sem_handle;
 
     pollfd _pollfd;
-    ObjectArray<CanTxItem> _tx_queue{100};
-    ObjectArray<CanRxItem> _rx_queue{100};
+    ObjectArray<CanTxItem> _tx_queue{HAL_SITL_CAN_QUEUE_LEN};
+    ObjectArray<CanRxItem> _rx_queue{HAL_SITL_CAN_QUEUE_LEN};
 
     /*
       bus statistics
@@ -137,7 +146,10 @@ private:
     HAL_Semaphore sem;
 
     bool add_to_rx_queue(const CanRxItem &rx_item) override {
-        _rx_queue.push(rx_item);
+        if (!_rx_queue.push(rx_item)) {
+            stats.rx_overflow++;
+            return false;
+        }
         return true;
     }
 
@@ -11,10 +11,15 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <linux/can.h>
+#include <linux/can/raw.h>
+#include <sys/socket.h>
 #include <errno.h>
 #include <stdlib.h>
 #include "CAN_SocketCAN.h"
 
+// frames moved per sendmmsg/recvmmsg call
+#define SOCKETCAN_BATCH_SIZE 32
+
 /*
   initialise socketcan transport
  */
@@ -43,6 +48,12 @@ bool CAN_SocketCAN::init(uint8_t instance)
         goto fail;
     }
 
+    {
+        // CAN FD needs the interface MTU set to 72, see can_sitl.sh
+        const int on = 1;
+        fd_frames = setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &on, sizeof(on)) == 0;
+    }
+
     return true;
 
 fail:
@@ -58,18 +69,7 @@ fail:
  */
 bool CAN_SocketCAN::send(const AP_HAL::CANFrame &frame)
 {
-    if (frame.canfd) {
-        // not supported on socketcan
-        return false;
-    }
-    struct can_frame transmit_frame {};
-    transmit_frame.can_id = frame.id;
-    transmit_frame.can_dlc = frame.dlc;
-
-    const uint8_t data_length = AP_HAL::CANFrame::dlcToDataLength(frame.dlc);
-    memcpy(transmit_frame.data, frame.data, data_length);
-
-    return ::write(fd, &transmit_frame, sizeof(transmit_frame)) == sizeof(transmit_frame);
+    return send_batch(&frame, 1) == 1;
 }
 
 /*
@@ -77,19 +77,91 @@ bool CAN_SocketCAN::send(const AP_HAL::CANFrame &frame)
  */
 bool CAN_SocketCAN::receive(AP_HAL::CANFrame &frame)
 {
-    struct can_frame receive_frame;
-    const ssize_t ret = ::read(fd, &receive_frame, sizeof(receive_frame));
-    if (ret != sizeof(receive_frame)) {
-        return false;
+    return receive_batch(&frame, 1) == 1;
+}
+
+/*
+  send a batch of CAN frames with one system call
+ */
+uint16_t CAN_SocketCAN::send_batch(const AP_HAL::CANFrame *frames, uint16_t count)
+{
+    struct canfd_frame transmit_frames[SOCKETCAN_BATCH_SIZE];
+    struct iovec iov[SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr msgs[SOCKETCAN_BATCH_SIZE] {};
+
+    count = MIN(count, SOCKETCAN_BATCH_SIZE);
+    for (uint16_t i=0; i<count; i++) {
+        const AP_HAL::CANFrame &frame = frames[i];
+        struct canfd_frame &transmit_frame = transmit_frames[i];
+        memset(&transmit_frame, 0, sizeof(transmit_frame));
+        transmit_frame.can_id = frame.id;
+        transmit_frame.len = AP_HAL::CANFrame::dlcToDataLength(frame.dlc);
+        memcpy(transmit_frame.data, frame.data, transmit_frame.len);
+
+        iov[i].iov_base = &transmit_frame;
+        iov[i].iov_len = CAN_MTU;
+        if (frame.canfd) {
+            if (!fd_frames) {
+                // not supported on this interface, send the frames before it
+                count = i;
+                break;
+            }
+            transmit_frame.flags = CANFD_BRS;
+            iov[i].iov_len = CANFD_MTU;
+        }
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    if (count == 0) {
+        return 0;
     }
 
-    // run constructor to initialise
-    new(&frame) AP_HAL::CANFrame(receive_frame.can_id, receive_frame.data, receive_frame.can_dlc, false);
+    const int ret = sendmmsg(fd, msgs, count, MSG_DONTWAIT);
+    return ret > 0 ? ret : 0;
+}
+
+/*
+  receive a batch of CAN frames with one system call
+ */
+uint16_t CAN_SocketCAN::receive_batch(AP_HAL::CANFrame *frames, uint16_t count)
+{
+    struct canfd_frame receive_frames[SOCKETCAN_BATCH_SIZE];
+    struct iovec iov[SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr msgs[SOCKETCAN_BATCH_SIZE] {};
+
+    count = MIN(count, SOCKETCAN_BATCH_SIZE);
+    for (uint16_t i=0; i<count; i++) {
+        iov[i].iov_base = &receive_frames[i];
+        iov[i].iov_len = sizeof(receive_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    if (sem_handle != nullptr) {
+    const int ret = recvmmsg(fd, msgs, count, MSG_DONTWAIT, nullptr);
+    if (ret <= 0) {
+        return 0;
+    }
+
+    uint16_t received = 0;
+    for (uint16_t i=0; i<ret; i++) {
+        const struct canfd_frame &receive_frame = receive_frames[i];
+        bool canfd;
+        if (msgs[i].msg_len == CAN_MTU) {
+            canfd = false;
+        } else if (msgs[i].msg_len == CANFD_MTU && HAL_CANFD_SUPPORTED) {
+            canfd = true;
+        } else {
+            continue;
+        }
+        // run constructor to initialise
+        new(&frames[received]) AP_HAL::CANFrame(receive_frame.can_id, receive_frame.data, receive_frame.len, canfd);
+        received++;
+    }
+
+    if (received > 0 && sem_handle != nullptr) {
         sem_handle->signal();
     }
-    return true;
+    return received;
 }
 
 #endif // HAL_NUM_CAN_IFACES
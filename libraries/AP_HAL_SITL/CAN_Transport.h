@@ -17,6 +17,25 @@ public:
     virtual bool receive(AP_HAL::CANFrame &frame) = 0;
     virtual int get_read_fd(void) const = 0;
 
+    // send up to count frames, returning the number sent. Transports
+    // able to move several frames per system call override this
+    virtual uint16_t send_batch(const AP_HAL::CANFrame *frames, uint16_t count) {
+        uint16_t sent = 0;
+        while (sent < count && send(frames[sent])) {
+            sent++;
+        }
+        return sent;
+    }
+
+    // receive up to count frames, returning the number received
+    virtual uint16_t receive_batch(AP_HAL::CANFrame *frames, uint16_t count) {
+        uint16_t received = 0;
+        while (received < count && receive(frames[received])) {
+            received++;
+        }
+        return received;
+    }
+
     void set_event_handle(AP_HAL::BinarySemaphore *handle) {
         sem_handle = handle;
     }
@@ -167,11 +167,20 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#if STORAGE_USE_FLASH
+        if (_initialisedType == StorageBackend::Flash) {
+            // use idle time to finish any sector switch
+            _flash.background_compact();
+        }
+#endif
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    // write out the first dirty line, along with up to
+    // STORAGE_FLUSH_LINES adjacent dirty lines. The last line of a
+    // run is usually still being written to, so it is left for the
+    // next call unless it is the only one. This keeps the latency of
+    // this call low while needing fewer flash blocks and device writes
     uint16_t i;
     for (i=0; i<STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -182,10 +191,19 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t n = 1;
+    while (n < STORAGE_FLUSH_LINES+1 && i+n < STORAGE_NUM_LINES && _dirty_mask.get(i+n)) {
+        n++;
+    }
+    if (n > 1) {
+        n--;
+    }
 
 #if STORAGE_USE_FRAM
-        if (fram.write(STORAGE_LINE_SIZE*i, &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE)) {
-            _dirty_mask.clear(i);
+        if (fram.write(STORAGE_LINE_SIZE*i, &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE*n)) {
+            for (uint16_t j=0; j<n; j++) {
+                _dirty_mask.clear(i+j);
+            }
             return;
         }
 #endif
@@ -197,10 +215,12 @@ void Storage::_timer_tick(void)
             if (lseek(log_fd, offset, SEEK_SET) != offset) {
                 return;
             }
-            if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
+            if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE*n) != STORAGE_LINE_SIZE*n) {
                 return;
             }
-            _dirty_mask.clear(i);
+            for (uint16_t j=0; j<n; j++) {
+                _dirty_mask.clear(i+j);
+            }
             return;
         }
     }
@@ -209,7 +229,7 @@ void Storage::_timer_tick(void)
 #if STORAGE_USE_FLASH
     if (hal.get_storage_flash_enabled()) {
         // save to storage backend
-        _flash_write(i);
+        _flash_write(i, n);
         return;
     }
 #endif
@@ -228,13 +248,16 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask. 
+  write nlines storage lines starting at line. This also updates
+  _dirty_mask.
 */
-void Storage::_flash_write(uint16_t line)
+void Storage::_flash_write(uint16_t line, uint16_t nlines)
 {
-    if (_flash.write(line*STORAGE_LINE_SIZE, STORAGE_LINE_SIZE)) {
-        // mark the line clean
-        _dirty_mask.clear(line);
+    if (_flash.write(line*STORAGE_LINE_SIZE, nlines*STORAGE_LINE_SIZE)) {
+        // mark the lines clean
+        for (uint16_t i=0; i<nlines; i++) {
+            _dirty_mask.clear(line+i);
+        }
     }
 }
 
@@ -386,6 +386,7 @@ public:
             BATCH_OPT_SENSOR_RATE = (1<<0),
             BATCH_OPT_POST_FILTER = (1<<1),
             BATCH_OPT_PRE_POST_FILTER = (1<<2),
+            BATCH_OPT_CONTINUOUS = (1<<3),
         };
 
         void rotate_to_next_sensor();
@@ -394,9 +395,35 @@ public:
         bool should_log(uint8_t instance, IMU_SENSOR_TYPE type) __RAMFUNC__;
         void push_data_to_log();
 
+        // continuous streaming of pre-filter samples for all sensors
+        // in the mask. Sensor threads fill a block per sensor and
+        // queue it, the main thread drains the queues into the log
+        void init_continuous();
+        void sample_continuous(uint8_t instance, IMU_SENSOR_TYPE type, uint64_t sample_us, const Vector3f &sample) __RAMFUNC__;
+        void push_continuous_to_log();
+
+        struct StreamBlock {
+            uint64_t sample_us;     // time of the first sample in the block
+            uint32_t seqno;         // per-sensor block number, a gap means lost samples
+            int16_t x[32];
+            int16_t y[32];
+            int16_t z[32];
+        };
+        struct Stream {
+            StreamBlock block;      // being filled by the sensor thread
+            uint8_t count;          // samples in block
+            uint32_t dropped;       // samples lost to a full queue
+            ObjectBuffer<StreamBlock> *queue;
+        };
+        // one stream per sensor, indexed by instance*2+type
+        Stream *streams;
+        uint8_t next_stream;        // stream to drain first, for fairness under backpressure
+
         // Logging functions
         bool Write_ISBH(const float sample_rate_hz) const;
         bool Write_ISBD() const;
+        bool Write_ISCH(uint8_t stream_idx) const;
+        bool Write_ISCD(uint8_t stream_idx, const StreamBlock &block) const;
 
         bool has_option(batch_opt_t option) const { return _batch_options_mask & uint16_t(option); }
 
@@ -815,14 +842,20 @@ public:
     void enable_fast_rate_buffer();
     // disable the fast rate buffer and stop pushing samples to it
     void disable_fast_rate_buffer();
-    // get the next available gyro sample from the fast rate buffer
-    bool get_next_gyro_sample(Vector3f& gyro);
+    // a filtered gyro sample and the time it was taken
+    struct FastRateSample {
+        Vector3f gyro;
+        uint32_t sample_us;
+    };
+    // get up to max_samples gyro samples from the fast rate buffer,
+    // oldest first, waiting if there are none
+    uint8_t get_next_gyro_samples(FastRateSample samples[], uint8_t max_samples);
     // get the number of available gyro samples in the fast rate buffer
     uint32_t get_num_gyro_samples();
     // set the rate at which samples are collected, unused samples are dropped
     void set_rate_decimation(uint8_t rdec);
     // push a new gyro sample into the fast rate buffer
-    bool push_next_gyro_sample(const Vector3f& gyro);
+    bool push_next_gyro_sample(const Vector3f& gyro, uint32_t sample_us);
     // run the filter parmeter update code.
     void update_backend_filters();
     // are rate loop samples enabled for this instance?
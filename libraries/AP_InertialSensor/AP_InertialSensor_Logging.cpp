@@ -139,6 +139,41 @@ bool AP_InertialSensor::BatchSampler::Write_ISBD() const
 
     return AP::logger().WriteBlock_first_succeed(&pkt, sizeof(pkt));
 }
+
+// Write the header for a continuous sampling stream:
+bool AP_InertialSensor::BatchSampler::Write_ISCH(uint8_t stream_idx) const
+{
+    const uint8_t _instance = stream_idx / 2;
+    const bool gyro = (stream_idx % 2) == IMU_SENSOR_TYPE_GYRO;
+    const struct log_ISCH pkt{
+        LOG_PACKET_HEADER_INIT(LOG_ISCH_MSG),
+        time_us        : AP_HAL::micros64(),
+        sensor_type    : uint8_t(stream_idx % 2),
+        instance       : _instance,
+        multiplier     : gyro ? _imu._gyro_raw_sampling_multiplier[_instance] : _imu._accel_raw_sampling_multiplier[_instance],
+        sample_rate_hz : gyro ? _imu._gyro_raw_sample_rates[_instance] : _imu._accel_raw_sample_rates[_instance],
+        dropped        : streams[stream_idx].dropped,
+    };
+
+    return AP::logger().WriteBlock_first_succeed(&pkt, sizeof(pkt));
+}
+
+// Write a block of a continuous sampling stream to log:
+bool AP_InertialSensor::BatchSampler::Write_ISCD(uint8_t stream_idx, const StreamBlock &block) const
+{
+    struct log_ISCD pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_ISCD_MSG),
+        time_us     : block.sample_us,
+        seqno       : block.seqno,
+        sensor_type : uint8_t(stream_idx % 2),
+        instance    : uint8_t(stream_idx / 2),
+    };
+    memcpy(pkt.x, block.x, sizeof(pkt.x));
+    memcpy(pkt.y, block.y, sizeof(pkt.y));
+    memcpy(pkt.z, block.z, sizeof(pkt.z));
+
+    return AP::logger().WriteBlock_first_succeed(&pkt, sizeof(pkt));
+}
 #endif
 
 #if AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
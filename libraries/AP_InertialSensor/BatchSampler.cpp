@@ -8,7 +8,7 @@
 const AP_Param::GroupInfo AP_InertialSensor::BatchSampler::var_info[] = {
     // @Param: BAT_CNT
     // @DisplayName: sample count per batch
-    // @Description: Number of samples to take when logging streams of IMU sensor readings.  Will be rounded down to a multiple of 32. This option takes effect on the next reboot.
+    // @Description: Number of samples to take when logging streams of IMU sensor readings.  Will be rounded down to a multiple of 32. In continuous mode this is the number of samples buffered per sensor while waiting for the logger. This option takes effect on the next reboot.
     // @User: Advanced
     // @Increment: 32
     // @RebootRequired: True
@@ -25,7 +25,7 @@ const AP_Param::GroupInfo AP_InertialSensor::BatchSampler::var_info[] = {
     // @Param: BAT_OPT
     // @DisplayName: Batch Logging Options Mask
     // @Description: Options for the BatchSampler.
-    // @Bitmask: 0:Sensor-Rate Logging (sample at full sensor rate seen by AP), 1: Sample post-filtering, 2: Sample pre- and post-filter
+    // @Bitmask: 0:Sensor-Rate Logging (sample at full sensor rate seen by AP), 1: Sample post-filtering, 2: Sample pre- and post-filter, 3: Continuous (stream pre-filter samples for all sensors in the mask without gaps, other options are ignored, takes effect on the next reboot)
     // @User: Advanced
     AP_GROUPINFO("BAT_OPT",  3, AP_InertialSensor::BatchSampler, _batch_options_mask, 0),
 
@@ -60,6 +60,11 @@ void AP_InertialSensor::BatchSampler::init()
 
     _real_required_count = _required_count;
 
+    if (has_option(BATCH_OPT_CONTINUOUS)) {
+        init_continuous();
+        return;
+    }
+
     const uint32_t total_allocation = 3*_real_required_count*sizeof(uint16_t);
     GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "INS: alloc %u bytes for ISB (free=%u)", (unsigned int)total_allocation, (unsigned int)hal.util->available_memory());
 
@@ -88,10 +93,56 @@ void AP_InertialSensor::BatchSampler::periodic()
         return;
     }
 #if HAL_LOGGING_ENABLED
+    if (streams != nullptr) {
+        push_continuous_to_log();
+        return;
+    }
     push_data_to_log();
 #endif
 }
 
+void AP_InertialSensor::BatchSampler::init_continuous()
+{
+    const uint8_t num_streams = INS_MAX_INSTANCES*2;
+    const uint16_t queue_blocks = MAX(_real_required_count / ARRAY_SIZE(StreamBlock::x), 2U);
+
+    // don't allocate for sensors we don't have
+    const uint8_t _count = MIN(_imu._accel_count, _imu._gyro_count);
+    const uint8_t mask = _sensor_mask & ((1U<<_count)-1);
+
+    uint8_t num_sensors = 0;
+    for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+        if (mask & (1U<<i)) {
+            num_sensors++;
+        }
+    }
+    const uint32_t total_allocation = num_streams*sizeof(Stream) + num_sensors*2*(queue_blocks+1)*sizeof(StreamBlock);
+    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "INS: alloc %u bytes for ISC (free=%u)", (unsigned int)total_allocation, (unsigned int)hal.util->available_memory());
+
+    streams = NEW_NOTHROW Stream[num_streams];
+    if (streams == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for IMU batch sampling", (unsigned int)total_allocation);
+        return;
+    }
+    for (uint8_t i=0; i<num_streams; i++) {
+        if (!(mask & (1U<<(i/2)))) {
+            continue;
+        }
+        streams[i].queue = NEW_NOTHROW ObjectBuffer<StreamBlock>(queue_blocks);
+        if (streams[i].queue == nullptr || streams[i].queue->get_size() == 0) {
+            for (uint8_t j=0; j<=i; j++) {
+                delete streams[j].queue;
+            }
+            delete[] streams;
+            streams = nullptr;
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for IMU batch sampling", (unsigned int)total_allocation);
+            return;
+        }
+    }
+
+    initialised = true;
+}
+
 void AP_InertialSensor::BatchSampler::update_doing_sensor_rate_logging()
 {
     if (has_option(BATCH_OPT_POST_FILTER)) {
@@ -269,11 +320,101 @@ bool AP_InertialSensor::BatchSampler::should_log(uint8_t _instance, IMU_SENSOR_T
     }
     return true;
 }
+
+/*
+  called from the sensor threads. Samples are packed into a block per
+  sensor and a full block is queued for the main thread. If the queue
+  is full the block is dropped and counted, the block sequence number
+  still advances so the gap shows up in the log
+ */
+void AP_InertialSensor::BatchSampler::sample_continuous(uint8_t _instance, AP_InertialSensor::IMU_SENSOR_TYPE _type, uint64_t sample_us, const Vector3f &_sample)
+{
+    if (_instance >= INS_MAX_INSTANCES) {
+        return;
+    }
+    Stream &s = streams[_instance*2 + uint8_t(_type)];
+    if (s.queue == nullptr) {
+        // not in the mask
+        return;
+    }
+
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->should_log(MASK_LOG_ANY)) {
+        // start a fresh block when logging starts again
+        s.count = 0;
+        return;
+    }
+
+    const uint16_t mul = _type == IMU_SENSOR_TYPE_GYRO ? _imu._gyro_raw_sampling_multiplier[_instance] : _imu._accel_raw_sampling_multiplier[_instance];
+    if (s.count == 0) {
+        s.block.sample_us = sample_us;
+    }
+    s.block.x[s.count] = mul*_sample.x;
+    s.block.y[s.count] = mul*_sample.y;
+    s.block.z[s.count] = mul*_sample.z;
+    s.count++;
+    if (s.count < ARRAY_SIZE(s.block.x)) {
+        return;
+    }
+
+    if (!s.queue->push(s.block)) {
+        s.dropped += s.count;
+    }
+    s.count = 0;
+    s.block.seqno++;
+}
+
+/*
+  drain the stream queues into the log. A block is only removed from
+  its queue once the logger has accepted it, so a busy logger pushes
+  back on the queues rather than losing data here
+ */
+void AP_InertialSensor::BatchSampler::push_continuous_to_log()
+{
+    if (AP_Logger::get_singleton() == nullptr) {
+        return;
+    }
+
+    const uint8_t num_streams = INS_MAX_INSTANCES*2;
+
+    // stream headers once a second, carrying the drop counts
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_sent_ms >= 1000) {
+        last_sent_ms = now_ms;
+        for (uint8_t i=0; i<num_streams; i++) {
+            if (streams[i].queue != nullptr) {
+                Write_ISCH(i);
+            }
+        }
+    }
+
+    for (uint8_t n=0; n<num_streams; n++) {
+        const uint8_t i = (next_stream + n) % num_streams;
+        Stream &s = streams[i];
+        if (s.queue == nullptr) {
+            continue;
+        }
+        StreamBlock block;
+        while (s.queue->peek(block)) {
+            if (!Write_ISCD(i, block)) {
+                // logger is full, start with this stream next time
+                next_stream = i;
+                return;
+            }
+            s.queue->pop();
+        }
+    }
+    next_stream = (next_stream + 1) % num_streams;
+}
 #endif  // HAL_LOGGING_ENABLED
 
 void AP_InertialSensor::BatchSampler::sample(uint8_t _instance, AP_InertialSensor::IMU_SENSOR_TYPE _type, uint64_t sample_us, const Vector3f &_sample)
 {
 #if HAL_LOGGING_ENABLED
+    if (streams != nullptr) {
+        sample_continuous(_instance, _type, sample_us, _sample);
+        return;
+    }
     if (!should_log(_instance, _type)) {
         return;
     }
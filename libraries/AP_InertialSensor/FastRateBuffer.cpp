@@ -89,38 +89,69 @@ bool AP_InertialSensor::is_dynamic_fifo_enabled(uint8_t instance) const
             && fast_rate_buffer->use_rate_loop_gyro_samples();
 }
 
-// get the next available gyro sample from the fast rate buffer
-bool AP_InertialSensor::get_next_gyro_sample(Vector3f& gyro)
+// get up to max_samples gyro samples from the fast rate buffer
+uint8_t AP_InertialSensor::get_next_gyro_samples(FastRateSample samples[], uint8_t max_samples)
 {
     if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
-        return false;
+        return 0;
     }
 
-    return fast_rate_buffer->get_next_gyro_sample(gyro);
+    return fast_rate_buffer->get_next_gyro_samples(samples, max_samples);
 }
 
-
-bool FastRateBuffer::get_next_gyro_sample(Vector3f& gyro)
+uint8_t FastRateBuffer::get_next_gyro_samples(AP_InertialSensor::FastRateSample samples[], uint8_t max_samples)
 {
     if (!use_rate_loop_gyro_samples()) {
-        return false;
+        return 0;
     }
 
-    if (_rate_loop_gyro_window.available() == 0) {
-        _notifier.wait_blocking();
+    if (get_num_gyro_samples() == 0) {
+        /*
+          flag that we are waiting and check again, the producer
+          checks the flag after publishing a sample so either we see
+          the sample here or it sees the flag and signals us
+         */
+        _consumer_waiting.store(true);
+        if (get_num_gyro_samples() == 0) {
+            _notifier.wait_blocking();
+        }
+        _consumer_waiting.store(false);
     }
 
-    WITH_SEMAPHORE(_mutex);
-
-    return _rate_loop_gyro_window.pop(gyro);
+    const uint8_t head = _head.load(std::memory_order_relaxed);
+    const uint8_t available = _tail.load(std::memory_order_acquire) - head;
+    const uint8_t n = MIN(available, max_samples);
+    for (uint8_t i=0; i<n; i++) {
+        samples[i] = _samples[uint8_t(head + i) % AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE];
+    }
+    _head.store(head + n, std::memory_order_release);
+    return n;
 }
 
 void FastRateBuffer::reset()
 {
-    _rate_loop_gyro_window.clear();
+    _head.store(_tail.load());
+}
+
+bool FastRateBuffer::push(const Vector3f &gyro, uint32_t sample_us)
+{
+    const uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (uint8_t(tail - _head.load(std::memory_order_acquire)) >= AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE) {
+        return false;
+    }
+    auto &sample = _samples[tail % AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE];
+    sample.gyro = gyro;
+    sample.sample_us = sample_us;
+    _tail.store(tail + 1);
+
+    // only wake the rate thread if it is waiting for us
+    if (_consumer_waiting.load()) {
+        _notifier.signal();
+    }
+    return true;
 }
 
-bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
+bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro, uint32_t sample_us)
 {
     if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
         return false;
@@ -129,16 +160,11 @@ bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
     if (++fast_rate_buffer->rate_decimation_count < fast_rate_buffer->rate_decimation) {
         return false;
     }
-    /*
-        tell the rate thread we have a new sample
-    */
-    WITH_SEMAPHORE(fast_rate_buffer->_mutex);
 
-    if (!fast_rate_buffer->_rate_loop_gyro_window.push(gyro)) {
+    if (!fast_rate_buffer->push(gyro, sample_us)) {
         debug("dropped rate loop sample");
     }
     fast_rate_buffer->rate_decimation_count = 0;
-    fast_rate_buffer->_notifier.signal();
     return true;
 }
 
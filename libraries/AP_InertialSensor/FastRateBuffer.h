@@ -18,34 +18,52 @@
 
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
 
-#define AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE 8     // gyro buffer size for rate loop
+#define AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE 8     // gyro buffer size for rate loop, must be a power of 2
 
+#include <atomic>
 #include <AP_HAL/AP_HAL_Boards.h>
-#include <AP_HAL/utility/RingBuffer.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_HAL/Semaphores.h>
 
+/*
+  single producer, single consumer ring of gyro samples from the
+  primary IMU backend to the rate thread. Neither side takes a lock,
+  the producer only signals the consumer when it is waiting for a
+  sample
+ */
 class FastRateBuffer
 {
     friend class AP_InertialSensor;
 public:
-    bool get_next_gyro_sample(Vector3f& gyro);
-    uint32_t get_num_gyro_samples() { return _rate_loop_gyro_window.available(); }
+    // consumer side: get up to max_samples samples, waiting if there are none
+    uint8_t get_next_gyro_samples(AP_InertialSensor::FastRateSample samples[], uint8_t max_samples);
+    uint32_t get_num_gyro_samples() const { return uint8_t(_tail.load() - _head.load()); }
     void set_rate_decimation(uint8_t rdec) { rate_decimation = rdec; }
     // whether or not to push the current gyro sample
     bool use_rate_loop_gyro_samples() const { return rate_decimation > 0; }
-    bool gyro_samples_available() { return  _rate_loop_gyro_window.available() > 0; }
+    bool gyro_samples_available() const { return get_num_gyro_samples() > 0; }
+    // consumer side: discard all samples
     void reset();
 
 private:
+    // producer side: add a sample, returns false if the ring is full
+    bool push(const Vector3f &gyro, uint32_t sample_us);
+
+    static_assert((AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE & (AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE - 1)) == 0,
+                  "rate loop buffer size must be a power of 2");
+    AP_InertialSensor::FastRateSample _samples[AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE];
+    // free running indexes, the head is only written by the consumer and the tail by the producer
+    std::atomic<uint8_t> _head;
+    std::atomic<uint8_t> _tail;
+    // set by the consumer before it blocks
+    std::atomic<bool> _consumer_waiting;
+
+    uint8_t rate_decimation; // 0 means off
+    uint8_t rate_decimation_count;
     /*
       binary semaphore for rate loop to use to start a rate loop when
-      we hav finished filtering the primary IMU
+      we have finished filtering the primary IMU
      */
-    ObjectBuffer<Vector3f> _rate_loop_gyro_window{AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE};
-    uint8_t rate_decimation; // 0 means off
-    uint8_t rate_decimation_count;
     HAL_BinarySemaphore _notifier;
-    HAL_Semaphore _mutex;
 };
 #endif
@@ -8,6 +8,8 @@
     LOG_IMU_MSG, \
     LOG_ISBH_MSG, \
     LOG_ISBD_MSG, \
+    LOG_ISCH_MSG, \
+    LOG_ISCD_MSG, \
     LOG_VIBE_MSG
 
 // @LoggerMessage: ACC
@@ -95,6 +97,45 @@ struct PACKED log_ISBD {
 };
 static_assert(sizeof(log_ISBD) < 256, "log_ISBD is over-size");
 
+// @LoggerMessage: ISCH
+// @Description: Continuous IMU batch sampling stream header, sent once a second per sensor
+// @Field: TimeUS: Time since system startup
+// @Field: type: sensor type, 0 for accelerometer, 1 for gyroscope
+// @Field: instance: sensor instance number
+// @Field: mul: multiplier applied to samples in ISCD
+// @Field: smp_rate: sample rate of the stream
+// @Field: drop: total number of samples dropped because the log could not keep up
+struct PACKED log_ISCH {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t sensor_type;
+    uint8_t instance;
+    uint16_t multiplier;
+    float sample_rate_hz;
+    uint32_t dropped;
+};
+
+// @LoggerMessage: ISCD
+// @Description: Continuous IMU batch sampling stream data, 32 consecutive samples of one sensor
+// @Field: TimeUS: Time since system startup the first sample was taken
+// @Field: N: block sequence number for this sensor, a gap means samples were dropped
+// @Field: type: sensor type, 0 for accelerometer, 1 for gyroscope
+// @Field: instance: sensor instance number
+// @Field: x: x-axis samples, scaled by ISCH mul
+// @Field: y: y-axis samples, scaled by ISCH mul
+// @Field: z: z-axis samples, scaled by ISCH mul
+struct PACKED log_ISCD {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t seqno;
+    uint8_t sensor_type;
+    uint8_t instance;
+    int16_t x[32];
+    int16_t y[32];
+    int16_t z[32];
+};
+static_assert(sizeof(log_ISCD) < 256, "log_ISCD is over-size");
+
 // @LoggerMessage: VIBE
 // @Description: Processed (acceleration) vibration information
 // @Field: TimeUS: Time since system startup
@@ -123,4 +164,8 @@ struct PACKED log_Vibe {
     { LOG_ISBH_MSG, sizeof(log_ISBH), \
       "ISBH", "QHBBHHQf", "TimeUS,N,type,instance,mul,smp_cnt,SampleUS,smp_rate", "s-----sz", "F-----F-" },  \
     { LOG_ISBD_MSG, sizeof(log_ISBD), \
-      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" },
+      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" },  \
+    { LOG_ISCH_MSG, sizeof(log_ISCH), \
+      "ISCH", "QBBHfI", "TimeUS,type,instance,mul,smp_rate,drop", "s---z-", "F-----" },  \
+    { LOG_ISCD_MSG, sizeof(log_ISCD), \
+      "ISCD", "QIBBaaa", "TimeUS,N,type,instance,x,y,z", "s---ooo", "F---???" },
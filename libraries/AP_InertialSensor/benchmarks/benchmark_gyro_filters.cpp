@@ -0,0 +1,171 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_InertialSensor/AP_InertialSensor_Backend.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/HarmonicNotchFilter.h>
+
+// sensor rate gyro path of AP_InertialSensor_Backend through the harmonic notches and low pass filter
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t gyro_rate_hz = 8000;
+static const uint8_t num_motors = 4;
+static const float motor_freq_hz[num_motors] { 160, 172, 181, 195 };
+
+// RPM notch on each motor with 3 harmonics, and a throttle notch
+static const uint32_t rpm_notch_harmonics = 0x7;
+static const uint32_t throttle_notch_harmonics = 0x3;
+
+// a backend fed with synthetic samples
+class AP_InertialSensor_Bench : public AP_InertialSensor_Backend
+{
+public:
+    AP_InertialSensor_Bench(AP_InertialSensor &imu) : AP_InertialSensor_Backend(imu) {}
+
+    bool update() override { return true; }
+
+    bool add_gyro(uint8_t &instance, uint32_t id) {
+        return _imu.register_gyro(instance, gyro_rate_hz, id);
+    }
+    void setup_filters(uint8_t instance) {
+        update_gyro_filters(instance);
+    }
+    void sample(uint8_t instance, const Vector3f &gyro, uint64_t sample_us) {
+        _notify_new_gyro_raw_sample(instance, gyro, sample_us);
+    }
+};
+
+static AP_InertialSensor ins;
+static AP_InertialSensor_Bench *backend;
+static uint8_t gyro_instance[INS_MAX_INSTANCES];
+
+static void setup_notch(AP_InertialSensor::HarmonicNotch &notch, uint32_t harmonics, uint16_t options, uint8_t num_notches)
+{
+    notch.params.enable();
+    notch.params.set_center_freq_hz(motor_freq_hz[0]);
+    notch.params.set_bandwidth_hz(motor_freq_hz[0] * 0.5);
+    notch.params.set_attenuation(40);
+    notch.params.set_harmonics(harmonics);
+    notch.params.set_freq_min_ratio(1.0);
+    notch.params.set_options(options | uint16_t(HarmonicNotchFilterParams::Options::EnableOnAllIMUs));
+    notch.num_dynamic_notches = num_notches;
+}
+
+/*
+  register the gyros and allocate the notches as AP_InertialSensor::init() would
+ */
+static void setup_ins()
+{
+    if (backend != nullptr) {
+        return;
+    }
+    backend = NEW_NOTHROW AP_InertialSensor_Bench(ins);
+
+    setup_notch(ins.harmonic_notches[0], rpm_notch_harmonics, uint16_t(HarmonicNotchFilterParams::Options::DoubleNotch), num_motors);
+    setup_notch(ins.harmonic_notches[1], throttle_notch_harmonics, 0, 1);
+
+    for (uint8_t i=0; i<3; i++) {
+        backend->add_gyro(gyro_instance[i], 0x1000+i);
+        for (uint8_t n=0; n<2; n++) {
+            auto &notch = ins.harmonic_notches[n];
+            notch.filter[gyro_instance[i]].allocate_filters(notch.num_dynamic_notches, notch.params.harmonics(),
+                                                            notch.params.num_composite_notches());
+            notch.filter[gyro_instance[i]].init(gyro_rate_hz, notch.params);
+        }
+        backend->setup_filters(gyro_instance[i]);
+        ins.harmonic_notches[0].filter[gyro_instance[i]].update(num_motors, motor_freq_hz);
+        ins.harmonic_notches[1].filter[gyro_instance[i]].update(motor_freq_hz[0]);
+    }
+}
+
+// sum of a few motor tones and a bias, sampled at the gyro rate
+static Vector3f synthetic_gyro(uint32_t n)
+{
+    const float t = n * (1.0 / gyro_rate_hz);
+    Vector3f gyro { 0.01, -0.02, 0.005 };
+    for (uint8_t m=0; m<num_motors; m++) {
+        const float s = sinf(t * motor_freq_hz[m] * M_2PI);
+        gyro += Vector3f{ 0.3f * s, -0.2f * s, 0.1f * s };
+    }
+    return gyro;
+}
+
+// one sample per IMU through the full backend filter chain
+static void BM_GyroFilterChain(benchmark::State& state)
+{
+    setup_ins();
+    const uint8_t num_imus = state.range(0);
+
+    Vector3f samples[gyro_rate_hz/100];
+    for (uint16_t i=0; i<ARRAY_SIZE(samples); i++) {
+        samples[i] = synthetic_gyro(i);
+    }
+
+    uint64_t sample_us = 1;
+    uint16_t idx = 0;
+    while (state.KeepRunning()) {
+        sample_us += 1000000U / gyro_rate_hz;
+        for (uint8_t i=0; i<num_imus; i++) {
+            backend->sample(gyro_instance[i], samples[idx], sample_us);
+        }
+        idx = (idx + 1) % ARRAY_SIZE(samples);
+    }
+    state.SetItemsProcessed(state.iterations() * num_imus);
+}
+
+/*
+  the notch cascade of one IMU on its own, with range(0) filters. The
+  per-notch version is how the cascade was run before
+  HarmonicNotchFilter had its own Vector3f implementation
+ */
+static void BM_NotchCascadePerNotch(benchmark::State& state)
+{
+    const uint16_t num_filters = state.range(0);
+    NotchFilterVector3f *filters = NEW_NOTHROW NotchFilterVector3f[num_filters];
+    for (uint16_t i=0; i<num_filters; i++) {
+        filters[i].init(gyro_rate_hz, 100 + 10*i, 40, 40);
+    }
+
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        Vector3f gyro = synthetic_gyro(n++);
+        for (uint16_t i=0; i<num_filters; i++) {
+            gyro = filters[i].apply(gyro);
+        }
+        gbenchmark_escape(&gyro);
+    }
+    delete[] filters;
+}
+
+static void BM_NotchCascadeHarmonic(benchmark::State& state)
+{
+    const uint16_t num_filters = state.range(0);
+    HarmonicNotchFilterParams params {};
+    params.set_center_freq_hz(100);
+    params.set_bandwidth_hz(40);
+    params.set_attenuation(40);
+    params.set_freq_min_ratio(1.0);
+
+    // one harmonic per notch, one notch per frequency
+    float freqs[HNF_MAX_HARMONICS];
+    for (uint16_t i=0; i<num_filters; i++) {
+        freqs[i] = 100 + 10*i;
+    }
+    HarmonicNotchFilterVector3f filter;
+    filter.allocate_filters(num_filters, 1, 1);
+    filter.init(gyro_rate_hz, params);
+    filter.update(num_filters, freqs);
+
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        Vector3f gyro = filter.apply(synthetic_gyro(n++));
+        gbenchmark_escape(&gyro);
+    }
+}
+
+BENCHMARK(BM_GyroFilterChain)->DenseRange(1, 3);
+BENCHMARK(BM_NotchCascadePerNotch)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK(BM_NotchCascadeHarmonic)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
+
+BENCHMARK_MAIN();
@@ -87,6 +87,12 @@ void AP_Mission::init()
         _cmd_total.set(0);
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_flush();
+#endif
+#if AP_MISSION_CMD_INDEX_ENABLED
+    cmd_index_init();
+#endif
 
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
@@ -553,6 +559,14 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 {
     // search until the end of the mission command list
     for (uint16_t cmd_index = start_index; cmd_index < (unsigned)_cmd_total; cmd_index++) {
+#if AP_MISSION_CMD_INDEX_ENABLED
+        // do commands would be returned as-is by get_next_cmd, so
+        // only navigation commands and jumps need to be looked at
+        cmd_index = cmd_index_find(cmd_index, true);
+        if (cmd_index >= (unsigned)_cmd_total) {
+            break;
+        }
+#endif
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -832,6 +846,12 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    if (cmd_cache_lookup(index, cmd)) {
+        return true;
+    }
+#endif
+
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -890,6 +910,10 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
     // set command's index to it's position in eeprom
     cmd.index = index;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_insert(cmd);
+#endif
+
     // return success
     return true;
 }
@@ -978,6 +1002,14 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // the stored form may differ from cmd, decode it again on next read
+    cmd_cache_invalidate(index);
+#endif
+#if AP_MISSION_CMD_INDEX_ENABLED
+    cmd_index_set(index, cmd.id);
+#endif
+
     // remember when the mission last changed
     if (index != 0) {
         // Update of home location is not a true change
@@ -2282,6 +2314,12 @@ uint16_t AP_Mission::get_index_of_jump_tag(const uint16_t tag) const
 {
     const auto count = num_commands();
     for (uint16_t i = 1; i < count; i++) {
+#if AP_MISSION_CMD_INDEX_ENABLED
+        i = cmd_index_find(i, false);
+        if (i >= count) {
+            break;
+        }
+#endif
         if (get_command_id(i) != uint16_t(MAV_CMD_JUMP_TAG)) {
             continue;
         }
@@ -2926,6 +2964,150 @@ uint16_t AP_Mission::get_command_id(uint16_t index) const
     return id;
 }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+/*
+  copy a command from the cache, returns false if it is not cached
+ */
+bool AP_Mission::cmd_cache_lookup(uint16_t index, Mission_Command &cmd) const
+{
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == index) {
+            e.last_use = ++_cmd_cache_tick;
+            cmd = e.cmd;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  add a decoded command to the cache, replacing the least recently used
+ */
+void AP_Mission::cmd_cache_insert(const Mission_Command &cmd) const
+{
+    CmdCacheEntry *victim = &_cmd_cache[0];
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == 0) {
+            victim = &e;
+            break;
+        }
+        if (e.last_use < victim->last_use) {
+            victim = &e;
+        }
+    }
+    victim->cmd = cmd;
+    victim->last_use = ++_cmd_cache_tick;
+}
+
+void AP_Mission::cmd_cache_invalidate(uint16_t index)
+{
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == index) {
+            e.cmd.index = 0;
+            e.last_use = 0;
+        }
+    }
+}
+
+void AP_Mission::cmd_cache_flush()
+{
+    WITH_SEMAPHORE(_rsem);
+    for (auto &e : _cmd_cache) {
+        e.cmd.index = 0;
+        e.last_use = 0;
+    }
+}
+#endif  // AP_MISSION_CMD_CACHE_SIZE
+
+#if AP_MISSION_CMD_INDEX_ENABLED
+/*
+  allocate the command index for the size of storage
+ */
+void AP_Mission::cmd_index_init()
+{
+    WITH_SEMAPHORE(_rsem);
+    delete[] _cmd_index.nav;
+    delete[] _cmd_index.jump;
+    const uint16_t nbytes = (_commands_max + 7U) / 8U;
+    _cmd_index.nav = NEW_NOTHROW uint8_t[nbytes];
+    _cmd_index.jump = NEW_NOTHROW uint8_t[nbytes];
+    if (_cmd_index.nav == nullptr || _cmd_index.jump == nullptr) {
+        delete[] _cmd_index.nav;
+        delete[] _cmd_index.jump;
+        _cmd_index.nav = nullptr;
+        _cmd_index.jump = nullptr;
+    }
+    _cmd_index.count = 0;
+}
+
+/*
+  record the type of the command stored at index
+ */
+void AP_Mission::cmd_index_set(uint16_t index, uint16_t id) const
+{
+    if (_cmd_index.nav == nullptr || index > _cmd_index.count || index >= _commands_max) {
+        // will be read from storage when the index is extended
+        return;
+    }
+    const uint8_t bit = 1U << (index % 8);
+    Mission_Command cmd {};
+    cmd.id = id;
+    // home is always returned as a waypoint
+    if (index == 0 || is_nav_cmd(cmd)) {
+        _cmd_index.nav[index/8] |= bit;
+    } else {
+        _cmd_index.nav[index/8] &= ~bit;
+    }
+    if (id == MAV_CMD_DO_JUMP || id == MAV_CMD_DO_JUMP_TAG || id == MAV_CMD_JUMP_TAG) {
+        _cmd_index.jump[index/8] |= bit;
+    } else {
+        _cmd_index.jump[index/8] &= ~bit;
+    }
+    if (index == _cmd_index.count) {
+        _cmd_index.count++;
+    }
+}
+
+/*
+  extend the index to cover all commands in the mission
+ */
+void AP_Mission::cmd_index_update() const
+{
+    const uint16_t total = MIN(uint16_t(_cmd_total.get()), _commands_max);
+    while (_cmd_index.nav != nullptr && _cmd_index.count < total) {
+        cmd_index_set(_cmd_index.count, get_command_id(_cmd_index.count));
+    }
+}
+
+uint16_t AP_Mission::cmd_index_find(uint16_t start, bool nav) const
+{
+    WITH_SEMAPHORE(_rsem);
+    cmd_index_update();
+    const uint16_t total = _cmd_total.get();
+    const uint16_t count = MIN(_cmd_index.count, total);
+    uint16_t i = start;
+    while (i < count) {
+        uint8_t bits = _cmd_index.jump[i/8];
+        if (nav) {
+            bits |= _cmd_index.nav[i/8];
+        }
+        bits >>= i % 8;
+        if (bits == 0) {
+            // nothing of interest in the rest of this byte
+            i = (i | 7U) + 1;
+            continue;
+        }
+        if (bits & 1U) {
+            return i;
+        }
+        i++;
+    }
+    // anything past count is not covered by the index and must be
+    // checked by the caller
+    return MIN(MAX(start, count), total);
+}
+#endif  // AP_MISSION_CMD_INDEX_ENABLED
+
 /*
   see if the mission contains a particular item
  */
@@ -929,6 +929,40 @@ private:
     // fast call to get command ID of a mission index
     uint16_t get_command_id(uint16_t index) const;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // LRU cache of decoded commands, protected by _rsem.  Home is
+    // never cached so an index of zero marks an empty entry
+    struct CmdCacheEntry {
+        Mission_Command cmd;
+        uint32_t last_use;
+    };
+    mutable CmdCacheEntry _cmd_cache[AP_MISSION_CMD_CACHE_SIZE];
+    mutable uint32_t _cmd_cache_tick;
+    bool cmd_cache_lookup(uint16_t index, Mission_Command &cmd) const;
+    void cmd_cache_insert(const Mission_Command &cmd) const;
+    void cmd_cache_invalidate(uint16_t index);
+    void cmd_cache_flush();
+#endif
+
+#if AP_MISSION_CMD_INDEX_ENABLED
+    // one bit per command in storage marking navigation commands and
+    // jumps (DO_JUMP, DO_JUMP_TAG and JUMP_TAG), so searches can skip
+    // do commands without reading them.  Covers the first count
+    // commands and is extended on demand, protected by _rsem
+    mutable struct {
+        uint8_t *nav;
+        uint8_t *jump;
+        uint16_t count;
+    } _cmd_index;
+    void cmd_index_init();
+    void cmd_index_set(uint16_t index, uint16_t id) const;
+    void cmd_index_update() const;
+    // return first index at or after start which is a navigation
+    // command (if nav is true) or a jump, or which is not covered by
+    // the index.  Returns _cmd_total if there is none
+    uint16_t cmd_index_find(uint16_t start, bool nav) const;
+#endif
+
     // memoisation of contains-relative:
     bool _contains_terrain_alt_items;  // true if the mission has terrain-relative items
     uint32_t _last_contains_relative_calculated_ms;  // will be equal to _last_change_time_ms if _contains_terrain_alt_items is up-to-date
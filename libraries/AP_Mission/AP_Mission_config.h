@@ -7,3 +7,17 @@
 #ifndef AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED
 #define AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED 1
 #endif
+
+// number of decoded commands kept in RAM, 0 disables the cache
+#ifndef AP_MISSION_CMD_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MISSION_CMD_CACHE_SIZE 32
+#else
+#define AP_MISSION_CMD_CACHE_SIZE 0
+#endif
+#endif
+
+// bitmaps of navigation and jump command positions for fast searches
+#ifndef AP_MISSION_CMD_INDEX_ENABLED
+#define AP_MISSION_CMD_INDEX_ENABLED HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#endif
@@ -51,6 +51,8 @@ private:
     void run_set_current_cmd_while_stopped_test();
     void run_replace_cmd_test();
     void run_max_cmd_test();
+    void init_mission_survey(uint16_t num_legs);
+    void run_survey_benchmark();
 
     AP_Mission mission{
             FUNCTOR_BIND_MEMBER(&MissionTest::start_cmd, bool, const AP_Mission::Mission_Command &),
@@ -1323,6 +1325,121 @@ void MissionTest::run_max_cmd_test()
     }
 }
 
+// init_mission_survey - initialise a survey mission of the kind a
+//      planner generates: each leg is a waypoint followed by camera and
+//      speed do commands, with a tagged repeat of the whole pattern
+void MissionTest::init_mission_survey(uint16_t num_legs)
+{
+    AP_Mission::Mission_Command cmd {};
+
+    mission.clear();
+
+    // Command #0 : home
+    cmd.id = MAV_CMD_NAV_WAYPOINT;
+    cmd.content.location = Location{12345678, 23456789, 0, Location::AltFrame::ABSOLUTE};
+    mission.add_cmd(cmd);
+
+    // Command #1 : take-off to 50m
+    cmd = {};
+    cmd.id = MAV_CMD_NAV_TAKEOFF;
+    cmd.content.location = Location{0, 0, 5000, Location::AltFrame::ABOVE_HOME};
+    mission.add_cmd(cmd);
+
+    // Command #2 : tag the start of the survey
+    cmd = {};
+    cmd.id = MAV_CMD_JUMP_TAG;
+    cmd.content.jump.target = 7;
+    mission.add_cmd(cmd);
+
+    for (uint16_t i=0; i<num_legs; i++) {
+        cmd = {};
+        cmd.id = MAV_CMD_NAV_WAYPOINT;
+        cmd.content.location = Location{12345678 + (i%2)*20000, 23456789 + i*100, 5000, Location::AltFrame::ABOVE_HOME};
+        mission.add_cmd(cmd);
+
+        cmd = {};
+        cmd.id = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
+        cmd.content.cam_trigg_dist.meters = (i%2) ? 20 : 0;
+        mission.add_cmd(cmd);
+
+        cmd = {};
+        cmd.id = MAV_CMD_DO_CHANGE_SPEED;
+        cmd.content.speed.target_ms = 12;
+        mission.add_cmd(cmd);
+    }
+
+    // repeat the survey once by tag, then land
+    cmd = {};
+    cmd.id = MAV_CMD_DO_JUMP_TAG;
+    cmd.content.jump.target = 7;
+    cmd.content.jump.num_times = 1;
+    mission.add_cmd(cmd);
+
+    cmd = {};
+    cmd.id = MAV_CMD_NAV_LAND;
+    mission.add_cmd(cmd);
+}
+
+// run_survey_benchmark - time the command lookups made when starting a
+//      large mission and following its jumps.  Build with
+//      AP_MISSION_CMD_CACHE_SIZE=0 and AP_MISSION_CMD_INDEX_ENABLED=0
+//      defined to compare against reading every command from storage
+void MissionTest::run_survey_benchmark()
+{
+    const uint16_t num_legs = MIN(240, (mission.num_commands_max() - 6) / 3);
+    init_mission_survey(num_legs);
+    hal.console->printf("Survey mission: %u commands\n", (unsigned)mission.num_commands());
+
+    AP_Mission::Mission_Command cmd;
+    const uint16_t count = mission.num_commands();
+
+    // walk the mission nav command by nav command, as advancing does
+    uint64_t t0 = AP_HAL::micros64();
+    uint16_t nav_count = 0;
+    for (uint8_t pass=0; pass<10; pass++) {
+        uint16_t index = 1;
+        while (index < count && mission.get_next_nav_cmd(index, cmd)) {
+            nav_count++;
+            index = cmd.index + 1;
+        }
+    }
+    hal.console->printf("get_next_nav_cmd: %u lookups %.1f us each\n",
+                        (unsigned)nav_count, (double)(AP_HAL::micros64() - t0) / MAX(nav_count, 1U));
+
+    // look up the next nav command from every index, as is done when
+    // jumping into the middle of the mission
+    t0 = AP_HAL::micros64();
+    for (uint16_t i=1; i<count; i++) {
+        mission.get_next_nav_cmd(i, cmd);
+    }
+    hal.console->printf("get_next_nav_cmd from every index: %.1f us each\n",
+                        (double)(AP_HAL::micros64() - t0) / count);
+
+    t0 = AP_HAL::micros64();
+    for (uint16_t i=0; i<100; i++) {
+        mission.get_index_of_jump_tag(7);
+    }
+    hal.console->printf("get_index_of_jump_tag: %.1f us each\n",
+                        (double)(AP_HAL::micros64() - t0) / 100);
+
+    // random access reads, as from the GCS, logger and terrain
+    t0 = AP_HAL::micros64();
+    for (uint16_t i=0; i<1000; i++) {
+        mission.read_cmd_from_storage(1 + (i * 7) % (count - 1), cmd);
+    }
+    hal.console->printf("read_cmd_from_storage: %.1f us each\n",
+                        (double)(AP_HAL::micros64() - t0) / 1000);
+
+    // jump around the mission while it is stopped, which loads the
+    // nav command at or after each index
+    t0 = AP_HAL::micros64();
+    for (uint16_t i=0; i<500; i++) {
+        mission.set_current_cmd(1 + (i * 31) % (count - 1));
+    }
+    hal.console->printf("set_current_cmd: %.1f us each\n",
+                        (double)(AP_HAL::micros64() - t0) / 500);
+}
+
 // setup
 void MissionTest::setup(void)
 {
@@ -1342,6 +1459,9 @@ void MissionTest::loop(void)
     // uncomment line below to run the mission pause/resume test
     //run_resume_test();
 
+    // uncomment line below to time command lookups on a large survey mission
+    //run_survey_benchmark();
+
     // wait forever
     while(true) {
         hal.scheduler->delay(1000);
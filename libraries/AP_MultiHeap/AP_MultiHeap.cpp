@@ -23,7 +23,7 @@ extern const AP_HAL::HAL &hal;
   create heaps with a total memory size, splitting over at most
   max_heaps
  */
-bool MultiHeap::create(uint32_t total_size, uint8_t max_heaps, bool _allow_expansion, uint32_t _reserve_size)
+bool MultiHeap::create(uint32_t total_size, uint8_t max_heaps, bool _allow_expansion, uint32_t _reserve_size, bool use_pools)
 {
     max_heaps = MIN(MAX_HEAPS, max_heaps);
     if (heaps != nullptr) {
@@ -58,6 +58,11 @@ bool MultiHeap::create(uint32_t total_size, uint8_t max_heaps, bool _allow_expan
     allow_expansion = _allow_expansion;
     reserve_size = _reserve_size;
 
+    if (use_pools) {
+        // without the chunk table all allocations go to the heaps
+        pool_chunks = NEW_NOTHROW PoolChunk*[MULTIHEAP_POOL_MAX_CHUNKS];
+    }
+
     return true;
 }
 
@@ -67,6 +72,7 @@ void MultiHeap::destroy(void)
     if (!available()) {
         return;
     }
+    pool_destroy();
     for (uint8_t i=0; i<num_heaps; i++) {
         if (heaps[i].hp != nullptr) {
             heap_destroy(heaps[i].hp);
@@ -87,23 +93,49 @@ bool MultiHeap::available(void) const
 }
 
 /*
-  allocate memory from a heap
+  allocate memory, from a pool for small sizes if possible
  */
 void *MultiHeap::allocate(uint32_t size)
 {
     if (!available() || size == 0) {
         return nullptr;
     }
+    if (pool_chunks != nullptr && size <= MULTIHEAP_POOL_MAX_BLOCK) {
+        void *ptr = pool_allocate(size);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+    }
+    return allocate_heap(size);
+}
+
+/*
+  allocate memory from the existing heaps, without expanding them
+ */
+void *MultiHeap::allocate_existing_heap(uint32_t size)
+{
     for (uint8_t i=0; i<num_heaps; i++) {
         if (heaps[i].hp == nullptr) {
             break;
         }
         void *newptr = heap_allocate(heaps[i].hp, size);
         if (newptr != nullptr) {
-            last_failed = false;
             return newptr;
         }
     }
+    return nullptr;
+}
+
+/*
+  allocate memory from a heap
+ */
+void *MultiHeap::allocate_heap(uint32_t size)
+{
+    void *newptr = allocate_existing_heap(size);
+    if (newptr != nullptr) {
+        last_failed = false;
+        return newptr;
+    }
     if (!allow_expansion || !last_failed) {
         /*
           we only allow expansion when the last allocation
@@ -167,6 +199,11 @@ void MultiHeap::deallocate(void *ptr)
     if (!available() || ptr == nullptr) {
         return;
     }
+    PoolChunk *chunk = pool_find(ptr);
+    if (chunk != nullptr) {
+        pool_free(chunk, ptr);
+        return;
+    }
     heap_free(ptr);
 }
 
@@ -186,6 +223,18 @@ void *MultiHeap::change_size(void *ptr, uint32_t old_size, uint32_t new_size)
       of having to move the allocation to a new heap, so we do a
       simple alloc/copy/deallocate for reallocation
      */
+    if (ptr != nullptr) {
+        // pooled blocks can change size in place unless they would
+        // waste more than half the block
+        const PoolChunk *chunk = pool_find(ptr);
+        if (chunk != nullptr) {
+            const uint32_t block_size = pool_block_size(chunk->size_class);
+            if (new_size <= block_size &&
+                (new_size*2 > block_size || pool_size_class(new_size) == chunk->size_class)) {
+                return ptr;
+            }
+        }
+    }
     void *newp = allocate(new_size);
     if (ptr == nullptr) {
         return newp;
@@ -203,4 +252,30 @@ void *MultiHeap::change_size(void *ptr, uint32_t old_size, uint32_t new_size)
     return newp;
 }
 
+/*
+  get memory usage statistics
+ */
+void MultiHeap::get_stats(Stats &stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    if (!available()) {
+        return;
+    }
+    stats.heap_size = sum_size;
+    for (uint8_t i=0; i<num_heaps; i++) {
+        if (heaps[i].hp == nullptr) {
+            break;
+        }
+        uint32_t free, largest;
+        heap_status(heaps[i].hp, free, largest);
+        stats.free += free;
+        stats.largest_free = MAX(stats.largest_free, largest);
+    }
+    for (uint16_t i=0; i<num_pool_chunks; i++) {
+        const PoolChunk *chunk = pool_chunks[i];
+        stats.pool_size += MULTIHEAP_POOL_CHUNK_SIZE;
+        stats.pool_used += chunk->used * pool_block_size(chunk->size_class);
+    }
+}
+
 #endif // ENABLE_HEAP
@@ -14,12 +14,30 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/*
+  small allocations can be served from pools of fixed size blocks,
+  carved out of chunks allocated on the heaps. This avoids
+  fragmenting the heaps with the many small objects lua creates
+ */
+#ifndef MULTIHEAP_POOL_CHUNK_SIZE
+#define MULTIHEAP_POOL_CHUNK_SIZE 512
+#endif
+
+#ifndef MULTIHEAP_POOL_MAX_CHUNKS
+#define MULTIHEAP_POOL_MAX_CHUNKS 256
+#endif
+
+// pooled block sizes are multiples of 8 up to this size
+#ifndef MULTIHEAP_POOL_MAX_BLOCK
+#define MULTIHEAP_POOL_MAX_BLOCK 64
+#endif
+
 class MultiHeap {
 public:
     /*
-      allocate/deallocate heaps
+      allocate/deallocate heaps, optionally with small object pools
      */
-    bool create(uint32_t total_size, uint8_t max_heaps, bool allow_expansion, uint32_t reserve_size);
+    bool create(uint32_t total_size, uint8_t max_heaps, bool allow_expansion, uint32_t reserve_size, bool use_pools=false);
     void destroy(void);
 
     // return true if the heap is available for operations
@@ -42,6 +60,17 @@ public:
         return expanded_to;
     }
 
+    struct Stats {
+        uint32_t heap_size;     // total size of all heaps, including expansion
+        uint32_t free;          // free memory in all heaps
+        uint32_t largest_free;  // largest block that could be allocated
+        uint32_t pool_size;     // heap memory held by the small object pools
+        uint32_t pool_used;     // memory in use in the small object pools
+    };
+
+    // get memory usage statistics
+    void get_stats(Stats &stats);
+
 private:
     struct Heap {
         void *hp;
@@ -59,6 +88,45 @@ private:
     // re-use memory when possible
     bool last_failed;
 
+    // allocate from the heaps, bypassing the pools
+    void *allocate_heap(uint32_t size);
+
+    // allocate from the heaps already created, leaving last_failed alone
+    void *allocate_existing_heap(uint32_t size);
+
+    /*
+      small object pools
+     */
+    struct PoolChunk {
+        PoolChunk *prev;        // list of chunks of this size with free blocks
+        PoolChunk *next;
+        void *free_list;        // freed blocks, linked through their first word
+        uint16_t used;          // blocks allocated to callers
+        uint16_t num_carved;    // blocks taken from the chunk so far
+        uint16_t num_blocks;
+        uint8_t size_class;
+    };
+    static const uint8_t num_pool_classes = MULTIHEAP_POOL_MAX_BLOCK / 8;
+    static uint32_t pool_block_size(uint8_t size_class) {
+        return (size_class + 1U) * 8U;
+    }
+    static uint8_t pool_size_class(uint32_t size) {
+        return (size - 1U) / 8U;
+    }
+
+    // chunks sorted by address so blocks can be matched to their chunk
+    PoolChunk **pool_chunks;
+    uint16_t num_pool_chunks;
+    // per size class list of chunks with free blocks
+    PoolChunk *pool_available[num_pool_classes];
+
+    void *pool_allocate(uint32_t size);
+    void pool_free(PoolChunk *chunk, void *ptr);
+    PoolChunk *pool_find(void *ptr) const;
+    PoolChunk *pool_add_chunk(uint8_t size_class);
+    void pool_release_chunk(PoolChunk *chunk);
+    void pool_destroy(void);
+
 
     /*
       low level allocation functions
@@ -78,6 +146,9 @@ private:
     // free some memory that was allocated by heap_allocate. The implementation must
     // be able to determine which heap the allocation was from using the pointer
     void heap_free(void *ptr);
+
+    // get the total free memory and the largest free block of a heap
+    void heap_status(void *heap, uint32_t &free, uint32_t &largest);
 };
 
 #endif // ENABLE_HEAP
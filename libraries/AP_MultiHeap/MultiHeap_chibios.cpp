@@ -44,4 +44,13 @@ void MultiHeap::heap_free(void *ptr)
     return chHeapFree(ptr);
 }
 
+void MultiHeap::heap_status(void *heap, uint32_t &free, uint32_t &largest)
+{
+    size_t total_free = 0;
+    size_t largest_free = 0;
+    chHeapStatus((memory_heap_t *)heap, &total_free, &largest_free);
+    free = total_free;
+    largest = largest_free;
+}
+
 #endif // ENABLE_HEAP && CONFIG_HAL_BOARD
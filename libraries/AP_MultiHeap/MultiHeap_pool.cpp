@@ -0,0 +1,180 @@
+/*
+  small object pools for MultiHeap. Each chunk holds blocks of a
+  single size class, chunks are kept sorted by address so that a
+  pointer can be matched to its chunk on free
+ */
+
+#include "AP_MultiHeap.h"
+
+#if ENABLE_HEAP
+
+#include <AP_Math/AP_Math.h>
+
+// blocks start after the chunk header, 8 byte aligned
+#define POOL_HEADER_SIZE ((sizeof(PoolChunk) + 7U) & ~7U)
+
+/*
+  allocate a block of at least size bytes, size must be no more than
+  MULTIHEAP_POOL_MAX_BLOCK
+ */
+void *MultiHeap::pool_allocate(uint32_t size)
+{
+    const uint8_t size_class = pool_size_class(size);
+    PoolChunk *chunk = pool_available[size_class];
+    if (chunk == nullptr) {
+        chunk = pool_add_chunk(size_class);
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+    }
+
+    void *ptr;
+    if (chunk->free_list != nullptr) {
+        ptr = chunk->free_list;
+        chunk->free_list = *(void **)ptr;
+    } else {
+        // blocks are carved on first use so new chunks are cheap
+        ptr = (uint8_t *)chunk + POOL_HEADER_SIZE + chunk->num_carved * pool_block_size(size_class);
+        chunk->num_carved++;
+    }
+    chunk->used++;
+
+    if (chunk->used == chunk->num_blocks) {
+        // full, remove from the available list
+        pool_available[size_class] = chunk->next;
+        if (chunk->next != nullptr) {
+            chunk->next->prev = nullptr;
+        }
+        chunk->next = nullptr;
+    }
+    return ptr;
+}
+
+/*
+  return a block to its chunk
+ */
+void MultiHeap::pool_free(PoolChunk *chunk, void *ptr)
+{
+    *(void **)ptr = chunk->free_list;
+    chunk->free_list = ptr;
+
+    const uint8_t size_class = chunk->size_class;
+    if (chunk->used == chunk->num_blocks) {
+        // was full, make it available again
+        chunk->prev = nullptr;
+        chunk->next = pool_available[size_class];
+        if (chunk->next != nullptr) {
+            chunk->next->prev = chunk;
+        }
+        pool_available[size_class] = chunk;
+    }
+    chunk->used--;
+
+    // give empty chunks back to the heap, keeping one per size class
+    // to avoid churn
+    if (chunk->used == 0 && (pool_available[size_class] != chunk || chunk->next != nullptr)) {
+        pool_release_chunk(chunk);
+    }
+}
+
+/*
+  find the chunk holding a pointer, nullptr if it is not pooled
+ */
+MultiHeap::PoolChunk *MultiHeap::pool_find(void *ptr) const
+{
+    const uintptr_t p = uintptr_t(ptr);
+    int32_t lo = 0;
+    int32_t hi = int32_t(num_pool_chunks) - 1;
+    PoolChunk *ret = nullptr;
+    while (lo <= hi) {
+        const int32_t mid = (lo + hi) / 2;
+        if (uintptr_t(pool_chunks[mid]) <= p) {
+            ret = pool_chunks[mid];
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (ret == nullptr || p >= uintptr_t(ret) + MULTIHEAP_POOL_CHUNK_SIZE) {
+        return nullptr;
+    }
+    return ret;
+}
+
+/*
+  allocate a new chunk for a size class from the heaps
+ */
+MultiHeap::PoolChunk *MultiHeap::pool_add_chunk(uint8_t size_class)
+{
+    if (num_pool_chunks >= MULTIHEAP_POOL_MAX_CHUNKS) {
+        return nullptr;
+    }
+    // a chunk must not expand the heaps or count as a failed
+    // allocation, the caller falls back to allocate_heap() which
+    // applies the expansion rules to the real request
+    PoolChunk *chunk = (PoolChunk *)allocate_existing_heap(MULTIHEAP_POOL_CHUNK_SIZE);
+    if (chunk == nullptr) {
+        return nullptr;
+    }
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->size_class = size_class;
+    chunk->num_blocks = (MULTIHEAP_POOL_CHUNK_SIZE - POOL_HEADER_SIZE) / pool_block_size(size_class);
+
+    // insert keeping the table sorted by address
+    uint16_t i = num_pool_chunks;
+    while (i > 0 && uintptr_t(pool_chunks[i-1]) > uintptr_t(chunk)) {
+        pool_chunks[i] = pool_chunks[i-1];
+        i--;
+    }
+    pool_chunks[i] = chunk;
+    num_pool_chunks++;
+
+    chunk->next = pool_available[size_class];
+    if (chunk->next != nullptr) {
+        chunk->next->prev = chunk;
+    }
+    pool_available[size_class] = chunk;
+
+    return chunk;
+}
+
+/*
+  free an empty chunk back to the heaps
+ */
+void MultiHeap::pool_release_chunk(PoolChunk *chunk)
+{
+    if (chunk->prev != nullptr) {
+        chunk->prev->next = chunk->next;
+    } else {
+        pool_available[chunk->size_class] = chunk->next;
+    }
+    if (chunk->next != nullptr) {
+        chunk->next->prev = chunk->prev;
+    }
+
+    for (uint16_t i=0; i<num_pool_chunks; i++) {
+        if (pool_chunks[i] == chunk) {
+            memmove(&pool_chunks[i], &pool_chunks[i+1], (num_pool_chunks - (i+1)) * sizeof(pool_chunks[0]));
+            num_pool_chunks--;
+            break;
+        }
+    }
+
+    heap_free(chunk);
+}
+
+/*
+  free all chunks, called before the heaps are destroyed
+ */
+void MultiHeap::pool_destroy(void)
+{
+    for (uint16_t i=0; i<num_pool_chunks; i++) {
+        heap_free(pool_chunks[i]);
+    }
+    delete[] pool_chunks;
+    pool_chunks = nullptr;
+    num_pool_chunks = 0;
+    memset(pool_available, 0, sizeof(pool_available));
+}
+
+#endif // ENABLE_HEAP
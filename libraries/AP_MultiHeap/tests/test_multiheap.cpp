@@ -54,4 +54,66 @@ TEST(MultiHeap, Tests)
     delete[] allocs;
 }
 
+/*
+  check small object pools keep allocations intact through resizing
+ */
+TEST(MultiHeap, Pools)
+{
+    static MultiHeap h;
+
+    EXPECT_TRUE(h.create(150000, 10, false, 10000, true));
+    EXPECT_TRUE(h.available());
+
+    const uint32_t max_allocs = 1000;
+    struct alloc {
+        uint8_t *ptr;
+        uint32_t size;
+        uint8_t fill;
+    };
+    auto *allocs = new alloc[max_allocs]{};
+
+    for (uint32_t i=0; i<20000; i++) {
+        const uint16_t idx = get_random16() % max_allocs;
+        auto &a = allocs[idx];
+        // mostly small sizes, as lua uses
+        const uint16_t size = (get_random16() % 4 == 0) ? get_random16() % 300 : get_random16() % 70;
+        for (uint32_t j=0; j<a.size; j++) {
+            EXPECT_EQ(a.ptr[j], a.fill);
+        }
+        if (a.ptr == nullptr) {
+            a.ptr = (uint8_t *)h.allocate(size);
+        } else {
+            a.ptr = (uint8_t *)h.change_size(a.ptr, a.size, size);
+        }
+        EXPECT_TRUE(size==0?a.ptr == nullptr : a.ptr != nullptr);
+        a.size = size;
+        a.fill = idx & 0xFF;
+        if (a.ptr != nullptr) {
+            memset(a.ptr, a.fill, a.size);
+        }
+    }
+
+    MultiHeap::Stats stats;
+    h.get_stats(stats);
+    EXPECT_EQ(stats.heap_size, 150000U);
+    EXPECT_GT(stats.pool_used, 0U);
+    EXPECT_LE(stats.pool_used, stats.pool_size);
+
+    for (uint32_t i=0; i<max_allocs; i++) {
+        auto &a = allocs[i];
+        for (uint32_t j=0; j<a.size; j++) {
+            EXPECT_EQ(a.ptr[j], a.fill);
+        }
+        h.deallocate(a.ptr);
+    }
+
+    // only the spare chunks are left
+    h.get_stats(stats);
+    EXPECT_EQ(stats.pool_used, 0U);
+    EXPECT_EQ(stats.free + stats.pool_size, stats.heap_size);
+
+    h.destroy();
+    delete[] allocs;
+}
+
 AP_GTEST_MAIN()
@@ -106,4 +106,8 @@ struct ekf_timing {
     float delVelDT_min;
 };
 
+// number of models in the EKFGSF yaw estimator bank. More models
+// converge faster from large initial yaw errors at the cost of CPU
+#ifndef N_MODELS_EKFGSF
 #define N_MODELS_EKFGSF 5U
+#endif
@@ -0,0 +1,58 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/EKFGSF_yaw.h>
+
+// EKFGSF yaw estimator model bank, as run at the IMU rate by each EKF3 core
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const ftype dt = 0.0025;
+
+static void update(EKFGSF_yaw &gsf, uint32_t step)
+{
+    const ftype t = step * dt;
+    const Vector3F delAng { 0.02f * sinF(t) * dt, 0.03f * cosF(0.7f * t) * dt, 0.1f * sinF(0.3f * t) * dt };
+    const Vector3F delVel { 0.5f * sinF(t) * dt, 0.4f * cosF(t) * dt, -GRAVITY_MSS * dt };
+    gsf.update(delAng, delVel, dt, dt, true, 0.0f);
+}
+
+/*
+  align the bank and start velocity fusion so all models are running
+ */
+static EKFGSF_yaw *setup_gsf()
+{
+    EKFGSF_yaw *gsf = NEW_NOTHROW EKFGSF_yaw();
+    for (uint32_t step=0; step<400; step++) {
+        update(*gsf, step);
+    }
+    gsf->fuseVelData(Vector2F{5.0f, 1.0f}, 0.3f);
+    return gsf;
+}
+
+static void BM_EKFGSFPredict(benchmark::State& state)
+{
+    EKFGSF_yaw *gsf = setup_gsf();
+    uint32_t step = 400;
+    while (state.KeepRunning()) {
+        update(*gsf, step++);
+    }
+    delete gsf;
+}
+
+static void BM_EKFGSFFuseVel(benchmark::State& state)
+{
+    EKFGSF_yaw *gsf = setup_gsf();
+    uint32_t step = 400;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        update(*gsf, step++);
+        state.ResumeTiming();
+        gsf->fuseVelData(Vector2F{5.0f, 1.0f}, 0.3f);
+    }
+    delete gsf;
+}
+
+BENCHMARK(BM_EKFGSFPredict);
+BENCHMARK(BM_EKFGSFFuseVel);
+
+BENCHMARK_MAIN();
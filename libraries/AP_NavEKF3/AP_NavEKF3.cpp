@@ -13,6 +13,8 @@
 
 #include <new>
 
+extern const AP_HAL::HAL& hal;
+
 /*
   parameter defaults for different types of vehicle. The
   APM_BUILD_DIRECTORY is taken from the main vehicle directory name
@@ -739,8 +741,8 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
 
     // @Param: OPTIONS
     // @DisplayName: Optional EKF behaviour
-    // @Description: This controls optional EKF behaviour. Setting JammingExpected will change the EKF nehaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad
-    // @Bitmask: 0:JammingExpected
+    // @Description: This controls optional EKF behaviour. Setting JammingExpected will change the EKF nehaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad GPS being used. Setting ParallelCores updates the odd numbered cores on a separate thread, which reduces the time taken by the EKF on Linux and SITL boards with more than one CPU. It has no effect on other boards.
+    // @Bitmask: 0:JammingExpected,1:ParallelCores
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  11, NavEKF3, _options, 0),
 
@@ -917,17 +919,33 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = dal.micros64();
 
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        bool allow_state_prediction = true;
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
-            allow_state_prediction = false;
+#if EK3_FEATURE_CORE_THREAD
+    core_thread.wait_us = 0;
+    core_thread.worker_us = 0;
+    if (option_is_enabled(Option::ParallelCores) && num_cores > 1) {
+        // the cores run at the same time, so the CPU budget check is
+        // made for all of them before any are updated
+        bool allow_state_prediction[MAX_EKF_CORES];
+        for (uint8_t i=0; i<num_cores; i++) {
+            allow_state_prediction[i] = core[i].getFramesSincePredict() >= (_framesPerPrediction+3) ||
+                !dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i);
+        }
+        updateCoresParallel(allow_state_prediction);
+    } else
+#endif
+    {
+        for (uint8_t i=0; i<num_cores; i++) {
+            // if we have not overrun by more than 3 IMU frames, and we
+            // have already used more than 1/3 of the CPU budget for this
+            // loop then suppress the prediction step. This allows
+            // multiple EKF instances to cooperate on scheduling
+            bool allow_state_prediction = true;
+            if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+                dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
+                allow_state_prediction = false;
+            }
+            core[i].UpdateFilter(allow_state_prediction);
         }
-        core[i].UpdateFilter(allow_state_prediction);
     }
 
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
@@ -1014,7 +1032,93 @@ void NavEKF3::UpdateFilter(void)
 
     // align position of inactive sources to ahrs
     sources.align_inactive_sources();
+
+#if EK3_FEATURE_CORE_THREAD
+    updateCoreThreadStats();
+#endif
+}
+
+#if EK3_FEATURE_CORE_THREAD
+/*
+  update every second core, starting at first_core
+ */
+void NavEKF3::updateCores(uint8_t first_core, const bool allow_state_prediction[])
+{
+    for (uint8_t i=first_core; i<num_cores; i+=2) {
+        core[i].UpdateFilter(allow_state_prediction[i]);
+    }
+}
+
+/*
+  update the cores with the odd numbered cores on a worker thread. The
+  cores only share the frontend, so the few places where one core
+  writes something another core reads are deferred until all cores
+  have finished. This keeps the result independent of thread timing,
+  which Replay relies on
+ */
+void NavEKF3::updateCoresParallel(const bool allow_state_prediction[])
+{
+    if (!core_thread.started) {
+        core_thread.started = true;
+        core_thread.running = hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&NavEKF3::core_thread_main, void),
+                                                           "EKF3",
+                                                           32768, AP_HAL::Scheduler::PRIORITY_MAIN, 0);
+        if (!core_thread.running) {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "EKF3: failed to start core thread");
+        }
+    }
+
+    core_thread.parallel = true;
+    if (core_thread.running) {
+        memcpy(core_thread.allow_state_prediction, allow_state_prediction, sizeof(core_thread.allow_state_prediction));
+        core_thread.start_sem.signal();
+        updateCores(0, allow_state_prediction);
+        const uint32_t wait_start_us = AP_HAL::micros();
+        core_thread.done_sem.wait_blocking();
+        core_thread.wait_us = AP_HAL::micros() - wait_start_us;
+    } else {
+        // no thread, update in the same order with the same rules
+        updateCores(0, allow_state_prediction);
+        const uint32_t worker_start_us = AP_HAL::micros();
+        updateCores(1, allow_state_prediction);
+        core_thread.worker_us = AP_HAL::micros() - worker_start_us;
+    }
+    core_thread.parallel = false;
+
+    // lowest numbered core to set an origin this frame makes it public
+    for (uint8_t i=0; i<num_cores; i++) {
+        core[i].publishPendingOrigin();
+    }
+}
+
+void NavEKF3::core_thread_main(void)
+{
+    while (true) {
+        core_thread.start_sem.wait_blocking();
+        const uint32_t start_us = AP_HAL::micros();
+        updateCores(1, core_thread.allow_state_prediction);
+        core_thread.worker_us = AP_HAL::micros() - start_us;
+        core_thread.done_sem.signal();
+    }
+}
+
+/*
+  accumulate the time from the start of the frame, when a new IMU
+  sample is available, to the end of the filter update
+ */
+void NavEKF3::updateCoreThreadStats(void)
+{
+#if !APM_BUILD_TYPE(APM_BUILD_Replay) && !APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone)
+    const uint32_t latency_us = AP_HAL::micros64() - imuSampleTime_us;
+    core_thread.count++;
+    core_thread.latency_sum_us += latency_us;
+    core_thread.latency_max_us = MAX(core_thread.latency_max_us, latency_us);
+    core_thread.wait_sum_us += core_thread.wait_us;
+    core_thread.wait_max_us = MAX(core_thread.wait_max_us, core_thread.wait_us);
+    core_thread.worker_sum_us += core_thread.worker_us;
+#endif
 }
+#endif  // EK3_FEATURE_CORE_THREAD
 
 /*
   check if switching lanes will reduce the normalised
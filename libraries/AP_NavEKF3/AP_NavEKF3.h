@@ -24,6 +24,8 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
+#include <AP_HAL/Semaphores.h>
+#include "AP_NavEKF3_feature.h"
 
 class NavEKF3_core;
 class EKFGSF_yaw;
@@ -455,6 +457,7 @@ private:
     // enum for processing options
     enum class Option {
         JammingExpected     = (1<<0),
+        ParallelCores       = (1<<1),
     };
     bool option_is_enabled(Option option) const {
         return (_options & (uint32_t)option) != 0;
@@ -543,6 +546,52 @@ private:
     // origin set by one of the cores
     Location common_EKF_origin;
     bool common_origin_valid;
+
+    // return true while cores are being updated on more than one thread
+    bool coresRunningParallel(void) const {
+#if EK3_FEATURE_CORE_THREAD
+        return core_thread.parallel;
+#else
+        return false;
+#endif
+    }
+
+#if EK3_FEATURE_CORE_THREAD
+    // update every second core starting at first_core
+    void updateCores(uint8_t first_core, const bool allow_state_prediction[]);
+
+    // update the even numbered cores on the calling thread while the
+    // odd numbered cores are updated on the worker thread
+    void updateCoresParallel(const bool allow_state_prediction[]);
+
+    // worker thread main loop
+    void core_thread_main(void);
+
+    // accumulate core update timing for this frame
+    void updateCoreThreadStats(void);
+
+    // write XKTH core update timing message
+    void Log_Write_Core_Thread(uint64_t time_us);
+
+    struct {
+        bool started;                           // thread creation has been attempted
+        bool running;                           // worker thread is available
+        bool parallel;                          // cores are being updated in parallel
+        HAL_BinarySemaphore start_sem;          // signalled to start the worker cores
+        HAL_BinarySemaphore done_sem;           // signalled when the worker cores are done
+        bool allow_state_prediction[MAX_EKF_CORES];
+        uint32_t worker_us;                     // time taken by the worker cores this frame
+        uint32_t wait_us;                       // time spent waiting for the worker this frame
+        // statistics since the last XKTH message
+        uint32_t count;
+        uint64_t latency_sum_us;
+        uint32_t latency_max_us;
+        uint64_t wait_sum_us;
+        uint32_t wait_max_us;
+        uint64_t worker_sum_us;
+        uint32_t last_log_ms;
+    } core_thread;
+#endif
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
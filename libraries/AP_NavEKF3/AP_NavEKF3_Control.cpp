@@ -714,14 +714,34 @@ bool NavEKF3_core::setOrigin(const Location &loc)
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
+    if (frontend->coresRunningParallel()) {
+        // other cores may be reading the public origin, the frontend
+        // publishes it once all cores have finished this update
+        originPublishPending = true;
+    } else {
+        publishOrigin();
+    }
+
+    return true;
+}
+
+// make our origin the public origin if no core has set one yet
+void NavEKF3_core::publishOrigin(void)
+{
     if (!frontend->common_origin_valid) {
         frontend->common_origin_valid = true;
         // put origin in frontend as well to ensure it stays in sync between lanes
         public_origin = EKF_origin;
     }
+}
 
-
-    return true;
+// publish an origin set while the cores were updated in parallel
+void NavEKF3_core::publishPendingOrigin(void)
+{
+    if (originPublishPending) {
+        originPublishPending = false;
+        publishOrigin();
+    }
 }
 
 // record all requested yaw resets completed
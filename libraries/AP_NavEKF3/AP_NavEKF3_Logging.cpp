@@ -374,9 +374,45 @@ void NavEKF3::Log_Write()
         core[i].Log_Write(time_us);
     }
 
+#if EK3_FEATURE_CORE_THREAD
+    Log_Write_Core_Thread(time_us);
+#endif
+
     AP::dal().start_frame(AP_DAL::FrameType::LogWriteEKF3);
 }
 
+#if EK3_FEATURE_CORE_THREAD
+void NavEKF3::Log_Write_Core_Thread(uint64_t time_us)
+{
+    // log core update timing every 5s
+    if (AP::dal().millis() - core_thread.last_log_ms <= 5000 || core_thread.count == 0) {
+        return;
+    }
+    core_thread.last_log_ms = AP::dal().millis();
+
+    const uint32_t count = core_thread.count;
+    const struct log_XKTH xkth{
+        LOG_PACKET_HEADER_INIT(LOG_XKTH_MSG),
+        time_us      : time_us,
+        count        : count,
+        parallel     : option_is_enabled(Option::ParallelCores) && num_cores > 1,
+        latency_avg  : uint32_t(core_thread.latency_sum_us / count),
+        latency_max  : core_thread.latency_max_us,
+        wait_avg     : uint32_t(core_thread.wait_sum_us / count),
+        wait_max     : core_thread.wait_max_us,
+        worker_avg   : uint32_t(core_thread.worker_sum_us / count),
+    };
+    core_thread.count = 0;
+    core_thread.latency_sum_us = 0;
+    core_thread.latency_max_us = 0;
+    core_thread.wait_sum_us = 0;
+    core_thread.wait_max_us = 0;
+    core_thread.worker_sum_us = 0;
+
+    AP::logger().WriteBlock(&xkth, sizeof(xkth));
+}
+#endif
+
 void NavEKF3_core::Log_Write(uint64_t time_us)
 {
     const auto level = frontend->_log_level;
@@ -230,6 +230,10 @@ public:
     // returns false if the origin has already been set
     bool setOriginLLH(const Location &loc);
 
+    // make an origin set while the cores were updated in parallel the
+    // public origin, unless another core has already set one
+    void publishPendingOrigin(void);
+
     // Set the EKF's NE horizontal position states and their corresponding variances from a supplied WGS-84 location and uncertainty
     // The altitude element of the location is not used.
     // Returns true if the set was successful
@@ -936,6 +940,9 @@ private:
     // returns false if the origin has already been set
     bool setOrigin(const Location &loc);
 
+    // make our origin the public origin if no core has set one yet
+    void publishOrigin(void);
+
     // Assess GPS data quality and set gpsGoodToAlign
     void calcGpsGoodToAlign(void);
 
@@ -1156,6 +1163,7 @@ private:
     Location EKF_origin;     // LLH origin of the NED axis system, internal only
     Location &public_origin; // LLH origin of the NED axis system, public functions
     bool validOrigin;               // true when the EKF origin is valid
+    bool originPublishPending;      // true when the EKF origin was set while cores were updated in parallel
     ftype gpsSpdAccuracy;           // estimated speed accuracy in m/s returned by the GPS receiver
     ftype gpsPosAccuracy;           // estimated position accuracy in m returned by the GPS receiver
     ftype gpsHgtAccuracy;           // estimated height accuracy in m returned by the GPS receiver
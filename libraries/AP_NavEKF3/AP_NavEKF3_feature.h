@@ -46,3 +46,8 @@
 #ifndef EK3_FEATURE_OPTFLOW_FUSION
 #define EK3_FEATURE_OPTFLOW_FUSION HAL_NAVEKF3_AVAILABLE && AP_OPTICALFLOW_ENABLED
 #endif
+
+// option to update cores on a worker thread, needs a multi-core CPU
+#ifndef EK3_FEATURE_CORE_THREAD
+#define EK3_FEATURE_CORE_THREAD EK3_FEATURE_ALL || CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#endif
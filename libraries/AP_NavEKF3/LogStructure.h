@@ -15,6 +15,7 @@
     LOG_XKFS_MSG, \
     LOG_XKQ_MSG,  \
     LOG_XKT_MSG,  \
+    LOG_XKTH_MSG, \
     LOG_XKTV_MSG, \
     LOG_XKV1_MSG, \
     LOG_XKV2_MSG, \
@@ -296,6 +297,27 @@ struct PACKED log_XKT {
     float delVelDT_max;
 };
 
+// @LoggerMessage: XKTH
+// @Description: EKF3 core update timing, including cores updated on a worker thread when EK3_OPTIONS bit 1 is set
+// @Field: TimeUS: Time since system startup
+// @Field: Cnt: count of filter updates used to create this message
+// @Field: Par: true if the cores were updated in parallel
+// @Field: LatAvg: average time from a new IMU sample being available to the end of the filter update
+// @Field: LatMax: largest time from a new IMU sample being available to the end of the filter update
+// @Field: WaitAvg: average time spent waiting for the worker thread to finish after updating the other cores
+// @Field: WaitMax: largest time spent waiting for the worker thread to finish after updating the other cores
+// @Field: WrkAvg: average time taken to update the cores on the worker thread
+struct PACKED log_XKTH {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t count;
+    uint8_t parallel;
+    uint32_t latency_avg;
+    uint32_t latency_max;
+    uint32_t wait_avg;
+    uint32_t wait_max;
+    uint32_t worker_avg;
+};
 
 // @LoggerMessage: XKFM
 // @Description: EKF3 diagnostic data for on-ground-and-not-moving check
@@ -451,6 +473,8 @@ struct PACKED log_XKV {
     { LOG_XKQ_MSG, sizeof(log_XKQ), "XKQ", "QBffff", "TimeUS,C,Q1,Q2,Q3,Q4", "s#????", "F-????" , true }, \
     { LOG_XKT_MSG, sizeof(log_XKT),   \
       "XKT", "QBIffffffff", "TimeUS,C,Cnt,IMUMin,IMUMax,EKFMin,EKFMax,AngMin,AngMax,VMin,VMax", "s#sssssssss", "F-000000000", true }, \
+    { LOG_XKTH_MSG, sizeof(log_XKTH),   \
+      "XKTH", "QIBIIIII", "TimeUS,Cnt,Par,LatAvg,LatMax,WaitAvg,WaitMax,WrkAvg", "s--sssss", "F--FFFFF", true }, \
     { LOG_XKTV_MSG, sizeof(log_XKTV),                         \
       "XKTV", "QBff", "TimeUS,C,TVS,TVD", "s#rr", "F-00", true }, \
     { LOG_XKV1_MSG, sizeof(log_XKV), \
@@ -242,7 +242,13 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
     }
 }
 
-bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
+/*
+  process a block of bytes from a uart. Once a protocol is detected the
+  whole block is handed to it in one call. While searching each byte
+  is given to every enabled protocol in turn, so the first protocol to
+  decode a frame wins just as if the bytes came one at a time
+ */
+bool AP_RCProtocol::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
 {
     uint32_t now = AP_HAL::millis();
     bool searching = should_search(now);
@@ -261,22 +267,38 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
         return false;
     }
 
-    // first try current protocol
-    if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
-        backend[_detected_protocol]->process_byte(byte, baudrate);
-        if (backend[_detected_protocol]->new_input()) {
-            _new_input = true;
-            _last_input_ms = now;
+    // enabled protocols, looked up once for the block
+    uint8_t detectors[ARRAY_SIZE(backend)];
+    uint8_t num_detectors = 0;
+
+    bool ret = false;
+    while (n > 0) {
+        // first try current protocol
+        if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
+            backend[_detected_protocol]->process_bytes(bytes, n, baudrate);
+            if (backend[_detected_protocol]->new_input()) {
+                _new_input = true;
+                _last_input_ms = now;
+            }
+            return true;
         }
-        return true;
-    }
 
-    // otherwise scan all protocols
-    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
+        if (num_detectors == 0) {
+            for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+                if (backend[i] != nullptr && protocol_enabled(rcprotocol_t(i))) {
+                    detectors[num_detectors++] = i;
+                }
             }
+            if (num_detectors == 0) {
+                return false;
+            }
+        }
+
+        // otherwise scan all protocols
+        const uint8_t byte = *bytes++;
+        n--;
+        for (uint8_t d = 0; d < num_detectors; d++) {
+            const uint8_t i = detectors[d];
             const uint32_t frame_count = backend[i]->get_rc_frame_count();
             const uint32_t input_count = backend[i]->get_rc_input_count();
             backend[i]->process_byte(byte, baudrate);
@@ -296,11 +318,13 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
                 }
                 // stop decoding pulses to save CPU
                 hal.rcin->pulse_input_enable(false);
-                return true;
+                ret = true;
+                searching = should_search(now);
+                break;
             }
         }
     }
-    return false;
+    return ret;
 }
 
 // handshake if nothing else has succeeded so far
@@ -378,13 +402,16 @@ void AP_RCProtocol::check_added_uart(void)
     const uint32_t current_baud = serial_configs[added.config_num].baud;
     process_handshake(current_baud);
 
+    uint8_t buf[64];
     uint32_t n = added.uart->available();
     n = MIN(n, 255U);
-    for (uint8_t i=0; i<n; i++) {
-        int16_t b = added.uart->read();
-        if (b >= 0) {
-            process_byte(uint8_t(b), current_baud);
+    while (n > 0) {
+        const ssize_t nread = added.uart->read(buf, MIN(n, sizeof(buf)));
+        if (nread <= 0) {
+            break;
         }
+        process_bytes(buf, nread, current_baud);
+        n -= nread;
     }
     if (searching) {
         if (now - added.last_config_change_ms > 1000) {
@@ -41,6 +41,17 @@ AP_RCProtocol_Backend::AP_RCProtocol_Backend(AP_RCProtocol &_frontend) :
     _num_channels(0)
 {}
 
+/*
+  process a block of bytes. Backends which can save work by handling
+  the whole block at once override this
+ */
+void AP_RCProtocol_Backend::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    for (uint16_t i=0; i<n; i++) {
+        process_byte(bytes[i], baudrate);
+    }
+}
+
 bool AP_RCProtocol_Backend::new_input()
 {
     bool ret = rc_input_count != last_rc_input_count;
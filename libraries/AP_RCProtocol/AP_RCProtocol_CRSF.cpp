@@ -214,21 +214,39 @@ uint16_t AP_RCProtocol_CRSF::get_link_rate(ProtocolType protocol) const {
     }
 }
 
+// return true if RC data may arrive at this baudrate
+bool AP_RCProtocol_CRSF::baudrate_ok(uint32_t baudrate) const
+{
+    return baudrate == CRSF_BAUDRATE || baudrate == CRSF_BAUDRATE_1MBIT || baudrate == CRSF_BAUDRATE_2MBIT;
+}
+
 // process a byte provided by a uart from rc stack
 void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
 {
     // reject RC data if we have been configured for standalone mode
-    if ((baudrate != CRSF_BAUDRATE && baudrate != CRSF_BAUDRATE_1MBIT && baudrate != CRSF_BAUDRATE_2MBIT) || _uart) {
+    if (!baudrate_ok(baudrate) || _uart) {
         return;
     }
     _process_byte(byte);
 }
 
+// process a block of bytes, all of which arrived by now
+void AP_RCProtocol_CRSF::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    // reject RC data if we have been configured for standalone mode
+    if (!baudrate_ok(baudrate) || _uart) {
+        return;
+    }
+    const uint32_t now = AP_HAL::micros();
+    for (uint16_t i = 0; i < n; i++) {
+        _process_byte(bytes[i], now);
+    }
+}
+
 // process a byte provided by a uart
-void AP_RCProtocol_CRSF::_process_byte(uint8_t byte)
+void AP_RCProtocol_CRSF::_process_byte(uint8_t byte, uint32_t now)
 {
     //debug("process_byte(0x%x)", byte);
-    const uint32_t now = AP_HAL::micros();
 
     // extra check for overflow, should never happen since it will have been handled in check_frame()
     if (_frame_ofs >= sizeof(_frame)) {
@@ -357,13 +375,19 @@ void AP_RCProtocol_CRSF::update(void)
             start_uart();
             _last_uart_start_time_ms = now;
         }
+        uint8_t buf[64];
         uint32_t n = _uart->available();
         n = MIN(n, 255U);
-        for (uint8_t i = 0; i < n; i++) {
-            int16_t b = _uart->read();
-            if (b >= 0) {
-                _process_byte(uint8_t(b));
+        while (n > 0) {
+            const ssize_t nread = _uart->read(buf, MIN(n, sizeof(buf)));
+            if (nread <= 0) {
+                break;
+            }
+            const uint32_t now_us = AP_HAL::micros();
+            for (uint8_t i = 0; i < nread; i++) {
+                _process_byte(buf[i], now_us);
             }
+            n -= nread;
         }
     }
 
@@ -213,4 +213,16 @@ void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+// support byte input, a block of bytes which all arrived by now
+void AP_RCProtocol_SBUS::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (baudrate != ss.baud()) {
+        return;
+    }
+    const uint32_t now_us = AP_HAL::micros();
+    for (uint16_t i=0; i<n; i++) {
+        _process_byte(now_us, bytes[i]);
+    }
+}
+
 #endif  // AP_RCPROTOCOL_SBUS_ENABLED
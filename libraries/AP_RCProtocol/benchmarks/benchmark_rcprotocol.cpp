@@ -0,0 +1,109 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <AP_VideoTX/AP_VideoTX.h>
+#include <RC_Channel/RC_Channel.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+// RC input handed to AP_RCProtocol in uart blocks, the argument is the block size and 1 uses process_byte()
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class RC_Channel_Bench : public RC_Channel {};
+
+class RC_Channels_Bench : public RC_Channels
+{
+public:
+    RC_Channel_Bench obj_channels[NUM_RC_CHANNELS];
+
+    RC_Channel_Bench *channel(const uint8_t chan) override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+
+protected:
+    int8_t flight_mode_channel_number() const override { return 5; }
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Bench
+#define RC_CHANNEL_SUBCLASS RC_Channel_Bench
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+static RC_Channels_Bench rchannels;
+static AP_SerialManager serial_manager;
+static AP_VideoTX vtx;
+GCS_Dummy _gcs;
+
+// RC channels frame captured from a CRSF receiver
+static const uint8_t crsf_frame[] = {
+    0xC8, 0x14, 0x17, 0x20, 0x03, 0x0C, 0xA0, 0x00, 0xF6, 0xB7, 0x6E, 0x94, 0xFC,
+    0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x0F, 0x6E
+};
+
+// 64 back to back frames, as a 1Mbit ELRS link delivers them
+static uint8_t crsf_stream[64 * sizeof(crsf_frame)];
+
+static void feed(AP_RCProtocol &rcprot, const uint8_t *bytes, uint32_t len, uint16_t block, uint32_t baudrate)
+{
+    if (block == 1) {
+        for (uint32_t i=0; i<len; i++) {
+            rcprot.process_byte(bytes[i], baudrate);
+        }
+        return;
+    }
+    while (len > 0) {
+        const uint16_t n = MIN(len, block);
+        rcprot.process_bytes(bytes, n, baudrate);
+        bytes += n;
+        len -= n;
+    }
+}
+
+// decoding once CRSF has been detected
+static void BM_RCProtocolCRSF(benchmark::State& state)
+{
+    const uint16_t block = state.range(0);
+    for (uint16_t i=0; i<ARRAY_SIZE(crsf_stream); i++) {
+        crsf_stream[i] = crsf_frame[i % sizeof(crsf_frame)];
+    }
+    AP_RCProtocol rcprot;
+    rcprot.init();
+    feed(rcprot, crsf_stream, sizeof(crsf_stream), block, 416666);
+    if (rcprot.protocol_detected() != AP_RCProtocol::CRSF) {
+        state.SkipWithError("CRSF not detected");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        feed(rcprot, crsf_stream, sizeof(crsf_stream), block, 416666);
+        bool new_input = rcprot.new_input();
+        gbenchmark_escape(&new_input);
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(crsf_stream));
+}
+
+// searching through line noise with every protocol enabled
+static void BM_RCProtocolSearch(benchmark::State& state)
+{
+    const uint16_t block = state.range(0);
+    static uint8_t noise[1024];
+    for (uint16_t i=0; i<ARRAY_SIZE(noise); i++) {
+        noise[i] = get_random16();
+    }
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    while (state.KeepRunning()) {
+        feed(rcprot, noise, sizeof(noise), block, 100000);
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(noise));
+}
+
+BENCHMARK(BM_RCProtocolCRSF)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_RCProtocolSearch)->Arg(1)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN();
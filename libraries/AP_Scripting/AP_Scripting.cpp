@@ -164,6 +164,42 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
 
+    // @Param: GC_US
+    // @DisplayName: Scripting garbage collection time budget
+    // @Description: Time spent on incremental garbage collection after each script run. Zero runs a full garbage collection after every script run, which keeps memory use lowest but can cause long pauses with many scripts.
+    // @Units: us
+    // @Range: 0 10000
+    // @User: Advanced
+    AP_GROUPINFO("GC_US", 19, AP_Scripting, _gc_budget_us, 0),
+
+#if AP_SCRIPTING_PROFILER_ENABLED
+    // @Param: PROF_ENABLE
+    // @DisplayName: Scripting profiler enable
+    // @Description: Enables a sampling profiler for scripts when scripting is restarted. The report is in @SYS/lua_profile.txt. Profiling slows scripts down, so only enable it while investigating.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("PROF_ENABLE", 22, AP_Scripting, _profile_enable, 0),
+#endif
+
+#if AP_SCRIPTING_MAX_THREADS > 1
+    // @Param: THREADS
+    // @DisplayName: Scripting threads
+    // @Description: Number of scripting threads. Each thread runs its own set of scripts in an isolated lua state with its own heap and VM instruction count, so a slow script only delays the scripts in its thread. The first thread runs the scripts in the scripts directory and ROMFS, additional threads run the scripts in the thread1 and thread2 subdirectories of the scripts directory. All threads use SCR_THD_PRIORITY and SCR_VM_I_COUNT.
+    // @Range: 1 3
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("THREADS", 20, AP_Scripting, _num_threads, 1),
+
+    // @Param: THD_HEAP
+    // @DisplayName: Scripting heap size for additional threads
+    // @Description: Amount of memory available for each additional scripting thread set by SCR_THREADS. The first thread uses SCR_HEAP_SIZE.
+    // @Increment: 1024
+    // @Range: 1024 1048576
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("THD_HEAP", 21, AP_Scripting, _thread_heap_size, SCRIPTING_HEAP_SIZE),
+#endif
+
 #if AP_SCRIPTING_SERIALDEVICE_ENABLED
     // @Param: SDEV_EN
     // @DisplayName: Scripting serial device enable
@@ -258,6 +294,19 @@ void AP_Scripting::init(void) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Scripting: %s", "failed to start");
         _thread_failed = true;
     }
+
+#if AP_SCRIPTING_MAX_THREADS > 1
+    static const char *thread_names[] = { "Scripting1", "Scripting2" };
+    static_assert(ARRAY_SIZE(thread_names) >= AP_SCRIPTING_MAX_THREADS - 1, "not enough thread names");
+    const uint8_t num_threads = constrain_int16(_num_threads, 1, AP_SCRIPTING_MAX_THREADS);
+    for (uint8_t i=1; i<num_threads; i++) {
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Scripting::extra_thread, void),
+                                          thread_names[i-1], SCRIPTING_STACK_SIZE, priority, 0)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Scripting: %s", "failed to start thread");
+            _thread_failed = true;
+        }
+    }
+#endif
 }
 
 #if AP_SCRIPTING_SERIALDEVICE_ENABLED
@@ -309,7 +358,7 @@ void AP_Scripting::thread(void) {
         _restart = false;
         _init_failed = false;
 
-        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_options);
+        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _gc_budget_us, _debug_options, profile_enabled(), 0);
         if (lua == nullptr || !lua->heap_allocated()) {
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "Unable to allocate memory");
             _init_failed = true;
@@ -322,6 +371,13 @@ void AP_Scripting::thread(void) {
 #if AP_ARMING_ENABLED && AP_ARMING_AUX_AUTH_ENABLED
             // Clear any dangling pre-arms from previous script loads
             AP_Arming::get_singleton()->reset_all_aux_auths();
+#endif
+#if AP_SCRIPTING_MAX_THREADS > 1
+            // start the other threads
+            {
+                WITH_SEMAPHORE(thread_sem);
+                run_count++;
+            }
 #endif
             // run won't return while scripting is still active
             lua->run();
@@ -332,6 +388,19 @@ void AP_Scripting::thread(void) {
         delete lua;
         lua = nullptr;
 
+#if AP_SCRIPTING_MAX_THREADS > 1
+        // the other threads must stop before the resources they share are freed
+        while (true) {
+            {
+                WITH_SEMAPHORE(thread_sem);
+                if (!should_run() && num_extra_threads_running == 0) {
+                    break;
+                }
+            }
+            hal.scheduler->delay(10);
+        }
+#endif
+
         // clear allocated i2c devices
         for (uint8_t i=0; i<SCRIPTING_MAX_NUM_I2C_DEVICE; i++) {
             delete _i2c_dev[i];
@@ -397,8 +466,55 @@ void AP_Scripting::thread(void) {
         }
     }
 }
+
+#if AP_SCRIPTING_MAX_THREADS > 1
+/*
+  additional scripting threads, each runs an independent lua state
+  for as long as the main thread is running
+ */
+void AP_Scripting::extra_thread(void) {
+    uint8_t thread_index;
+    {
+        WITH_SEMAPHORE(thread_sem);
+        thread_index = ++num_extra_threads;
+    }
+
+    uint32_t last_run_count = 0;
+    while (true) {
+        hal.scheduler->delay(100);
+        {
+            WITH_SEMAPHORE(thread_sem);
+            if (run_count == last_run_count || !should_run()) {
+                continue;
+            }
+            last_run_count = run_count;
+            num_extra_threads_running++;
+        }
+
+        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _thread_heap_size, _gc_budget_us, _debug_options, profile_enabled(), thread_index);
+        if (lua == nullptr || !lua->heap_allocated()) {
+            GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting %u: %s", unsigned(thread_index), "Unable to allocate memory");
+        } else {
+            lua->run();
+        }
+        delete lua;
+
+        {
+            WITH_SEMAPHORE(thread_sem);
+            num_extra_threads_running--;
+        }
+    }
+}
+#endif // AP_SCRIPTING_MAX_THREADS > 1
 #pragma GCC pop_options
 
+#if AP_SCRIPTING_PROFILER_ENABLED
+void AP_Scripting::profile_info(ExpandingString &str)
+{
+    lua_scripts::profile_info(str);
+}
+#endif
+
 void AP_Scripting::handle_mission_command(const AP_Mission::Mission_Command& cmd_in)
 {
 #if AP_MISSION_ENABLED
@@ -20,6 +20,7 @@
 
 #include <GCS_MAVLink/GCS_config.h>
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Mission/AP_Mission.h>
@@ -73,6 +74,11 @@ public:
 
     static AP_Scripting * get_singleton(void) { return _singleton; }
 
+#if AP_SCRIPTING_PROFILER_ENABLED
+    // report for @SYS/lua_profile.txt
+    void profile_info(ExpandingString &str);
+#endif
+
     static const struct AP_Param::GroupInfo var_info[];
 
 #if HAL_GCS_ENABLED
@@ -94,6 +100,9 @@ public:
     };
     uint16_t get_disabled_dir() { return uint16_t(_dir_disable.get());}
 
+    // protects the device storage below, which is shared by all scripting threads
+    HAL_Semaphore resource_sem;
+
     // the number of and storage for i2c devices
     uint8_t num_i2c_devices;
     AP_HAL::I2CDevice *_i2c_dev[SCRIPTING_MAX_NUM_I2C_DEVICE];
@@ -120,8 +129,6 @@ public:
     // PWMSource storage
     uint8_t num_pwm_source;
     AP_HAL::PWMSource *_pwm_source[SCRIPTING_MAX_NUM_PWM_SOURCE];
-    int get_current_env_ref() { return current_env_ref; }
-    void set_current_env_ref(int ref) { current_env_ref = ref; }
 
 #if AP_NETWORKING_ENABLED
     // SocketAPM storage
@@ -166,6 +173,18 @@ private:
 
     void thread(void); // main script execution thread
 
+#if AP_SCRIPTING_MAX_THREADS > 1
+    void extra_thread(void); // additional script execution threads
+
+    AP_Int8 _num_threads;
+    AP_Int32 _thread_heap_size;
+
+    HAL_Semaphore thread_sem;
+    uint8_t num_extra_threads;          // threads started, used to assign thread indexes
+    uint8_t num_extra_threads_running;  // threads with a lua state
+    uint32_t run_count;                 // incremented each time the main thread starts its scripts
+#endif
+
     // Check if DEBUG_OPTS bit has been set to save current checksum values to params
     void save_checksum();
 
@@ -189,6 +208,10 @@ private:
     AP_Int32 _script_vm_exec_count;
     AP_Int32 _script_heap_size;
     AP_Int8 _debug_options;
+    AP_Int16 _gc_budget_us;
+#if AP_SCRIPTING_PROFILER_ENABLED
+    AP_Int8 _profile_enable;
+#endif
     AP_Int16 _dir_disable;
     AP_Int32 _required_loaded_checksum;
     AP_Int32 _required_running_checksum;
@@ -203,13 +226,20 @@ private:
         _debug_options.set_and_save(_debug_options.get() & ~uint8_t(option));
     }
 
+    bool profile_enabled() const {
+#if AP_SCRIPTING_PROFILER_ENABLED
+        return _profile_enable.get() != 0;
+#else
+        return false;
+#endif
+    }
+
     bool _thread_failed; // thread allocation failed
     bool _init_failed;  // true if memory allocation failed
     bool _restart; // true if scripts should be restarted
     bool _stop; // true if scripts should be stopped
 
     static AP_Scripting *_singleton;
-    int current_env_ref;
 };
 
 namespace AP {
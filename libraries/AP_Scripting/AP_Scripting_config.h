@@ -15,6 +15,24 @@
     #endif
 #endif
 
+// serve small lua objects from pools to reduce heap fragmentation
+#ifndef AP_SCRIPTING_HEAP_POOLS_ENABLED
+#define AP_SCRIPTING_HEAP_POOLS_ENABLED 1
+#endif
+
+// maximum number of scripting threads, each with its own lua state and heap
+#ifndef AP_SCRIPTING_MAX_THREADS
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || defined(STM32H7)
+#define AP_SCRIPTING_MAX_THREADS 3
+#else
+#define AP_SCRIPTING_MAX_THREADS 1
+#endif
+#endif
+
+#ifndef AP_SCRIPTING_PROFILER_ENABLED
+#define AP_SCRIPTING_PROFILER_ENABLED AP_SCRIPTING_ENABLED
+#endif
+
 #ifndef AP_SCRIPTING_SERIALDEVICE_ENABLED
 #define AP_SCRIPTING_SERIALDEVICE_ENABLED AP_SERIALMANAGER_REGISTER_ENABLED && (HAL_PROGRAM_SIZE_LIMIT_KB>1024)
 #endif
@@ -0,0 +1,80 @@
+--[[
+ Microbenchmark of commonly used bindings. Each update times a batch of
+ calls to one binding and reports the average cost per call in
+ microseconds. The batch is kept small so the run fits within the
+ default SCR_VM_I_COUNT.
+--]]
+
+local ITERATIONS = 200
+
+local v1 = Vector3f()
+v1:x(1)
+v1:y(2)
+v1:z(3)
+local v2 = v1:copy()
+local sum
+local loc = Location()
+local vm_param = Parameter('SCR_VM_I_COUNT')
+
+local benchmarks = {
+  { "ahrs:get_location", function()
+      for _ = 1, ITERATIONS do
+        ahrs:get_location()
+      end
+  end },
+  { "param:get", function()
+      for _ = 1, ITERATIONS do
+        param:get('SCR_VM_I_COUNT')
+      end
+  end },
+  { "Parameter:get", function()
+      for _ = 1, ITERATIONS do
+        vm_param:get()
+      end
+  end },
+  { "Vector3f add", function()
+      for _ = 1, ITERATIONS do
+        sum = v1 + v2
+      end
+  end },
+  { "Vector3f:length", function()
+      for _ = 1, ITERATIONS do
+        v1:length()
+      end
+  end },
+  { "Location:lat", function()
+      for _ = 1, ITERATIONS do
+        loc:lat()
+      end
+  end },
+}
+
+-- the empty loop cost is subtracted from each result
+local function empty_loop()
+  for _ = 1, ITERATIONS do
+  end
+end
+
+local function time_us(fn)
+  local t0 = micros()
+  fn()
+  return (micros() - t0):tofloat()
+end
+
+local index = 1
+
+function update()
+  local name = benchmarks[index][1]
+  local overhead = time_us(empty_loop)
+  local elapsed = time_us(benchmarks[index][2])
+  gcs:send_text(6, string.format("bench %s: %.2f us/call", name, (elapsed - overhead) / ITERATIONS))
+
+  assert(sum == nil or sum:x() == 2)
+  index = index + 1
+  if index > #benchmarks then
+    index = 1
+  end
+  return update, 1000
+end
+
+return update, 1000
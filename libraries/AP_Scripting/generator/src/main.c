@@ -1333,11 +1333,15 @@ void emit_userdata_allocators(void) {
   struct userdata * node = parsed_userdata;
   while (node) {
     start_dependency(source, node->dependency);
+    // address of this is used as the registry key for the metatable, avoiding a string lookup.
+    // It is not const so the compiler can't merge the keys of different types
+    fprintf(source, "static char %s_metatable_key;\n\n", node->sanatized_name);
+
     // New method used internally
     fprintf(source, "%s * new_%s(lua_State *L) {\n", node->name, node->sanatized_name);
     fprintf(source, "    void *ud = lua_newuserdata(L, sizeof(%s));\n", node->name);
     fprintf(source, "    new (ud) %s();\n", node->name);
-    fprintf(source, "    luaL_getmetatable(L, \"%s\");\n", node->rename ? node->rename :  node->name);
+    fprintf(source, "    lua_rawgetp(L, LUA_REGISTRYINDEX, &%s_metatable_key);\n", node->sanatized_name);
     fprintf(source, "    lua_setmetatable(L, -2);\n");
     fprintf(source, "    return (%s *)ud;\n", node->name);
     fprintf(source, "}\n");
@@ -1382,7 +1386,7 @@ void emit_userdata_checkers(void) {
   while (node) {
     start_dependency(source, node->dependency);
     fprintf(source, "%s * check_%s(lua_State *L, int arg) {\n", node->name, node->sanatized_name);
-    fprintf(source, "    return (%s *)luaL_checkudata(L, arg, \"%s\");\n", node->name, node->rename ? node->rename :  node->name);
+    fprintf(source, "    return (%s *)check_userdata(L, arg, &%s_metatable_key, \"%s\");\n", node->name, node->sanatized_name, node->rename ? node->rename :  node->name);
     fprintf(source, "}\n");
     end_dependency(source, node->dependency);
     fprintf(source, "\n");
@@ -2540,9 +2544,9 @@ void emit_type_index_with_operators(struct userdata * data, char * meta_name) {
   while (data) {
     start_dependency(source, data->dependency);
     if (data->operations == 0) {
-      fprintf(source, "    {\"%s\", %s_index, nullptr},\n", data->rename ? data->rename : data->name, data->sanatized_name);
+      fprintf(source, "    {\"%s\", %s_index, nullptr, &%s_metatable_key},\n", data->rename ? data->rename : data->name, data->sanatized_name, data->sanatized_name);
     } else {
-      fprintf(source, "    {\"%s\", %s_index, %s_operators},\n", data->rename ? data->rename : data->name, data->sanatized_name, data->sanatized_name);
+      fprintf(source, "    {\"%s\", %s_index, %s_operators, &%s_metatable_key},\n", data->rename ? data->rename : data->name, data->sanatized_name, data->sanatized_name, data->sanatized_name);
     }
     end_dependency(source, data->dependency);
     data = data->next;
@@ -2564,7 +2568,7 @@ void emit_loaders(void) {
   fprintf(source, "        if (strcmp(name, singleton_fun[i].name) == 0) {\n");
   fprintf(source, "            lua_newuserdata(L, 0);\n");
   fprintf(source, "            if (luaL_newmetatable(L, name)) { // need to create metatable\n");
-  fprintf(source, "                lua_pushcfunction(L, singleton_fun[i].func);\n");
+  fprintf(source, "                push_cached_index(L, singleton_fun[i].func);\n");
   fprintf(source, "                lua_setfield(L, -2, \"__index\");\n");
   fprintf(source, "            }\n");
   fprintf(source, "            lua_setmetatable(L, -2);\n");
@@ -2598,21 +2602,22 @@ void emit_loaders(void) {
   fprintf(source, "    // userdata metatables\n");
   fprintf(source, "    for (uint32_t i = 0; i < ARRAY_SIZE(userdata_fun); i++) {\n");
   fprintf(source, "        luaL_newmetatable(L, userdata_fun[i].name);\n");
-  fprintf(source, "        lua_pushcfunction(L, userdata_fun[i].func);\n");
+  fprintf(source, "        push_cached_index(L, userdata_fun[i].func);\n");
   fprintf(source, "        lua_setfield(L, -2, \"__index\");\n");
 
   fprintf(source, "        if (userdata_fun[i].operators != nullptr) {\n");
   fprintf(source, "            luaL_setfuncs(L, userdata_fun[i].operators, 0);\n");
   fprintf(source, "        }\n");
 
-  fprintf(source, "        lua_pop(L, 1);\n");
+  fprintf(source, "        // also store by address for new_ and check_ to avoid string lookups\n");
+  fprintf(source, "        lua_rawsetp(L, LUA_REGISTRYINDEX, userdata_fun[i].metatable_key);\n");
   fprintf(source, "    }\n");
   fprintf(source, "\n");
 
   fprintf(source, "    // ap object metatables\n");
   fprintf(source, "    for (uint32_t i = 0; i < ARRAY_SIZE(ap_object_fun); i++) {\n");
   fprintf(source, "        luaL_newmetatable(L, ap_object_fun[i].name);\n");
-  fprintf(source, "        lua_pushcfunction(L, ap_object_fun[i].func);\n");
+  fprintf(source, "        push_cached_index(L, ap_object_fun[i].func);\n");
   fprintf(source, "        lua_setfield(L, -2, \"__index\");\n");
 
   fprintf(source, "        lua_pop(L, 1);\n");
@@ -2753,6 +2758,19 @@ void emit_argcheck_helper(void) {
   fprintf(source, "    return lua_unint32;\n");
   fprintf(source, "}\n\n");
 
+  fprintf(source, "void * check_userdata(lua_State *L, int arg_num, const void * key, const char * name) {\n");
+  fprintf(source, "    void * ud = lua_touserdata(L, arg_num);\n");
+  fprintf(source, "    if ((ud != nullptr) && lua_getmetatable(L, arg_num)) {\n");
+  fprintf(source, "        lua_rawgetp(L, LUA_REGISTRYINDEX, key);\n");
+  fprintf(source, "        const bool match = lua_rawequal(L, -1, -2);\n");
+  fprintf(source, "        lua_pop(L, 2);\n");
+  fprintf(source, "        if (match) {\n");
+  fprintf(source, "            return ud;\n");
+  fprintf(source, "        }\n");
+  fprintf(source, "    }\n");
+  fprintf(source, "    return luaL_checkudata(L, arg_num, name); // raises the type error\n");
+  fprintf(source, "}\n\n");
+
   fprintf(source, "void * new_ap_object(lua_State *L, size_t size, const char * name) {\n");
   fprintf(source, "    void * ud = lua_newuserdata(L, size);\n");
   fprintf(source, "    luaL_getmetatable(L, name);\n");
@@ -3048,6 +3066,30 @@ void emit_index_helpers(void) {
   fprintf(source, "    return 0;\n");
   fprintf(source, "}\n\n");
 
+  // __index wrapper which remembers the result of the linear search in an upvalue table
+  fprintf(source, "static int cached_index(lua_State *L) {\n");
+  fprintf(source, "    lua_settop(L, 2);\n");
+  fprintf(source, "    lua_pushvalue(L, 2);\n");
+  fprintf(source, "    if (lua_rawget(L, lua_upvalueindex(1)) != LUA_TNIL) {\n");
+  fprintf(source, "        return 1;\n");
+  fprintf(source, "    }\n");
+  fprintf(source, "    lua_pop(L, 1);\n");
+  fprintf(source, "    const int ret = lua_tocfunction(L, lua_upvalueindex(2))(L);\n");
+  fprintf(source, "    if ((ret == 1) && !lua_isnil(L, -1)) {\n");
+  fprintf(source, "        // functions and enums do not depend on the object, so are safe to cache\n");
+  fprintf(source, "        lua_pushvalue(L, 2);\n");
+  fprintf(source, "        lua_pushvalue(L, -2);\n");
+  fprintf(source, "        lua_rawset(L, lua_upvalueindex(1));\n");
+  fprintf(source, "    }\n");
+  fprintf(source, "    return ret;\n");
+  fprintf(source, "}\n\n");
+
+  fprintf(source, "static void push_cached_index(lua_State *L, lua_CFunction index) {\n");
+  fprintf(source, "    lua_newtable(L);\n");
+  fprintf(source, "    lua_pushcfunction(L, index);\n");
+  fprintf(source, "    lua_pushcclosure(L, cached_index, 2);\n");
+  fprintf(source, "}\n\n");
+
   // If enough stuff is defined out we can end up with no enums.
   // Rather than work out which defines we would need, just ignore the unused function error.
   fprintf(source, "#pragma GCC diagnostic push\n");
@@ -3080,6 +3122,7 @@ void emit_structs(void) {
   fprintf(source, "    const char *name;\n");
   fprintf(source, "    lua_CFunction func;\n");
   fprintf(source, "    const luaL_Reg *operators;\n");
+  fprintf(source, "    const void *metatable_key;\n");
   fprintf(source, "};\n\n");
 }
 
@@ -3261,6 +3304,7 @@ int main(int argc, char **argv) {
   fprintf(header, "uint16_t get_uint16_t(lua_State *L, int arg_num);\n");
   fprintf(header, "float get_number(lua_State *L, int arg_num, float min_val, float max_val);\n");
   fprintf(header, "uint32_t get_uint32(lua_State *L, int arg_num, uint32_t min_val, uint32_t max_val);\n");
+  fprintf(header, "void * check_userdata(lua_State *L, int arg_num, const void * key, const char * name);\n");
   fprintf(header, "void * new_ap_object(lua_State *L, size_t size, const char * name);\n");
   fprintf(header, "void ** check_ap_object(lua_State *L, int arg_num, const char * name);\n");
 
@@ -338,7 +338,12 @@ static int luaB_load (lua_State *L) {
   int status;
   size_t l;
   const char *s = lua_tolstring(L, 1, &l);
+#if LUA_SUPPORT_LOAD_BINARY
+  // precompiled chunks are only accepted from script files, never from a running script
+  const char *mode = "t";
+#else
   const char *mode = luaL_optstring(L, 3, "bt");
+#endif
   int env = (!lua_isnone(L, 4) ? 4 : 0);  /* 'env' index or 0 if no 'env' */
   if (s != NULL) {  /* loading a string? */
     const char *chunkname = luaL_optstring(L, 2, s);
@@ -12,6 +12,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 
 #include "lua_bindings.h"
+#include "lua_scripts.h"
 
 #include "lua_boxed_numerics.h"
 #include <AP_Scripting/lua_generated_bindings.h>
@@ -30,6 +31,17 @@ extern "C" {
 
 extern const AP_HAL::HAL& hal;
 
+/*
+  the mavlink and mission receive queues and the serial ports are
+  shared by all scripts, so are only available to the scripts run by
+  the main scripting thread
+ */
+static void check_primary_state(lua_State *L) {
+    if (!lua_scripts::is_primary_state(L)) {
+        luaL_error(L, "not available in scripting threads");
+    }
+}
+
 // millis
 int lua_millis(lua_State *L) {
     binding_argcheck(L, 0);
@@ -55,6 +67,7 @@ int lua_mavlink_init(lua_State *L) {
     const int arg_offset = (luaL_testudata(L, 1, "mavlink") != NULL) ? 1 : 0;
 
     binding_argcheck(L, 2+arg_offset);
+    check_primary_state(L);
     // get the depth of receive queue
     const uint32_t queue_size = get_uint32(L, 1+arg_offset, 0, 25);
     // get number of msgs to accept
@@ -96,6 +109,7 @@ int lua_mavlink_receive_chan(lua_State *L) {
     const int arg_offset = (luaL_testudata(L, 1, "mavlink") != NULL) ? 1 : 0;
 
     binding_argcheck(L, arg_offset);
+    check_primary_state(L);
 
     struct AP_Scripting::mavlink_msg msg;
     ObjectBuffer<struct AP_Scripting::mavlink_msg> *rx_buffer = AP::scripting()->mavlink_data.rx_buffer;
@@ -121,36 +135,38 @@ int lua_mavlink_register_rx_msgid(lua_State *L) {
     const int arg_offset = (luaL_testudata(L, 1, "mavlink") != NULL) ? 1 : 0;
 
     binding_argcheck(L, 1+arg_offset);
+    check_primary_state(L);
 
     const uint32_t msgid = get_uint32(L, 1+arg_offset, 0, (1 << 24) - 1);
 
     struct AP_Scripting::mavlink &data = AP::scripting()->mavlink_data;
 
-    // check that we aren't currently watching this ID
-    for (uint8_t i = 0; i < data.accept_msg_ids_size; i++) {
-        if (data.accept_msg_ids[i] == msgid) {
-            lua_pushboolean(L, false);
-            return 1;
+    bool registered = false;
+    bool full = true;
+    {
+        WITH_SEMAPHORE(data.sem);
+        for (uint8_t i = 0; i < data.accept_msg_ids_size; i++) {
+            if (data.accept_msg_ids[i] == msgid) {
+                // we are already watching this ID
+                registered = true;
+                full = false;
+                break;
+            }
         }
-    }
-
-    int i = 0;
-    for (i = 0; i < data.accept_msg_ids_size; i++) {
-        if (data.accept_msg_ids[i] == UINT32_MAX) {
-            break;
+        for (uint8_t i = 0; !registered && i < data.accept_msg_ids_size; i++) {
+            if (data.accept_msg_ids[i] == UINT32_MAX) {
+                data.accept_msg_ids[i] = msgid;
+                full = false;
+                break;
+            }
         }
-    }
+    } // release semaphore here as luaL_error will NOT do that!
 
-    if (i >= data.accept_msg_ids_size) {
+    if (full) {
         return luaL_error(L, "no registrations free");
     }
 
-    {
-        WITH_SEMAPHORE(data.sem);
-        data.accept_msg_ids[i] = msgid;
-    }
-
-    lua_pushboolean(L, true);
+    lua_pushboolean(L, !registered);
     return 1;
 }
 
@@ -230,6 +246,7 @@ int lua_mavlink_block_command(lua_State *L) {
 #if AP_MISSION_ENABLED
 int lua_mission_receive(lua_State *L) {
     binding_argcheck(L, 0);
+    check_primary_state(L);
 
     ObjectBuffer<struct AP_Scripting::scripting_mission_cmd> *input = AP::scripting()->mission_data;
 
@@ -595,19 +612,28 @@ int lua_get_i2c_device(lua_State *L) {
     auto *scripting = AP::scripting();
 
     static_assert(SCRIPTING_MAX_NUM_I2C_DEVICE >= 0, "There cannot be a negative number of I2C devices");
-    if (scripting->num_i2c_devices >= SCRIPTING_MAX_NUM_I2C_DEVICE) {
+    bool full = false;
+    AP_HAL::I2CDevice *dev = nullptr;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
+        if (scripting->num_i2c_devices >= SCRIPTING_MAX_NUM_I2C_DEVICE) {
+            full = true;
+        } else {
+            dev = hal.i2c_mgr->get_device_ptr(bus, address, bus_clock, use_smbus);
+            if (dev != nullptr) {
+                scripting->_i2c_dev[scripting->num_i2c_devices++] = dev;
+            }
+        }
+    } // release semaphore here as luaL_argerror will NOT do that!
+
+    if (full) {
         return luaL_argerror(L, 1, "no i2c devices available");
     }
-
-    scripting->_i2c_dev[scripting->num_i2c_devices] = hal.i2c_mgr->get_device_ptr(bus, address, bus_clock, use_smbus);
-
-    if (scripting->_i2c_dev[scripting->num_i2c_devices] == nullptr) {
+    if (dev == nullptr) {
         return luaL_argerror(L, 1, "i2c device nullptr");
     }
 
-    *new_AP_HAL__I2CDevice(L) = scripting->_i2c_dev[scripting->num_i2c_devices];
-
-    scripting->num_i2c_devices++;
+    *new_AP_HAL__I2CDevice(L) = dev;
 
     return 1;
 }
@@ -694,20 +720,25 @@ int lua_get_CAN_device(lua_State *L) {
 
     auto *scripting = AP::scripting();
 
-    if (scripting->_CAN_dev == nullptr) {
-        scripting->_CAN_dev = NEW_NOTHROW ScriptingCANSensor(AP_CAN::Protocol::Scripting);
+    ScriptingCANSensor *dev;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
         if (scripting->_CAN_dev == nullptr) {
-            return luaL_argerror(L, 1, "CAN device nullptr");
+            scripting->_CAN_dev = NEW_NOTHROW ScriptingCANSensor(AP_CAN::Protocol::Scripting);
         }
+        dev = scripting->_CAN_dev;
+    } // release semaphore here as luaL_argerror will NOT do that!
+    if (dev == nullptr) {
+        return luaL_argerror(L, 1, "CAN device nullptr");
     }
 
-    if (!scripting->_CAN_dev->initialized()) {
+    if (!dev->initialized()) {
         // Driver not initialized, probably because there is no can driver set to scripting
         // Return nil
         return 0;
     }
 
-    *new_ScriptingCANBuffer(L) = scripting->_CAN_dev->add_buffer(buffer_len);
+    *new_ScriptingCANBuffer(L) = dev->add_buffer(buffer_len);
 
     return 1;
 }
@@ -724,20 +755,25 @@ int lua_get_CAN_device2(lua_State *L) {
 
     auto *scripting = AP::scripting();
 
-    if (scripting->_CAN_dev2 == nullptr) {
-        scripting->_CAN_dev2 = NEW_NOTHROW ScriptingCANSensor(AP_CAN::Protocol::Scripting2);
+    ScriptingCANSensor *dev;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
         if (scripting->_CAN_dev2 == nullptr) {
-            return luaL_argerror(L, 1, "CAN device nullptr");
+            scripting->_CAN_dev2 = NEW_NOTHROW ScriptingCANSensor(AP_CAN::Protocol::Scripting2);
         }
+        dev = scripting->_CAN_dev2;
+    } // release semaphore here as luaL_argerror will NOT do that!
+    if (dev == nullptr) {
+        return luaL_argerror(L, 1, "CAN device nullptr");
     }
 
-    if (!scripting->_CAN_dev2->initialized()) {
+    if (!dev->initialized()) {
         // Driver not initialized, probably because there is no can driver set to scripting 2
         // Return nil
         return 0;
     }
 
-    *new_ScriptingCANBuffer(L) = scripting->_CAN_dev2->add_buffer(buffer_len);
+    *new_ScriptingCANBuffer(L) = dev->add_buffer(buffer_len);
 
     return 1;
 }
@@ -749,6 +785,7 @@ int lua_serial_find_serial(lua_State *L) {
     const int arg_offset = (luaL_testudata(L, 1, "serial") != NULL) ? 1 : 0;
 
     binding_argcheck(L, 1 + arg_offset);
+    check_primary_state(L);
 
     uint8_t instance = get_uint8_t(L, 1 + arg_offset);
 
@@ -776,6 +813,7 @@ int lua_serial_find_simulated_device(lua_State *L) {
     const int arg_offset = (luaL_testudata(L, 1, "serial") != NULL) ? 1 : 0;
 
     binding_argcheck(L, 2 + arg_offset);
+    check_primary_state(L);
 
     const int8_t protocol = (int8_t)get_uint32(L, 1 + arg_offset, 0, 127);
     uint32_t instance = get_uint16_t(L, 2 + arg_offset);
@@ -900,18 +938,28 @@ int lua_get_PWMSource(lua_State *L) {
     auto *scripting = AP::scripting();
 
     static_assert(SCRIPTING_MAX_NUM_PWM_SOURCE >= 0, "There cannot be a negative number of PWMSources");
-    if (scripting->num_pwm_source >= SCRIPTING_MAX_NUM_PWM_SOURCE) {
+    bool full = false;
+    AP_HAL::PWMSource *source = nullptr;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
+        if (scripting->num_pwm_source >= SCRIPTING_MAX_NUM_PWM_SOURCE) {
+            full = true;
+        } else {
+            source = NEW_NOTHROW AP_HAL::PWMSource;
+            if (source != nullptr) {
+                scripting->_pwm_source[scripting->num_pwm_source++] = source;
+            }
+        }
+    } // release semaphore here as luaL_argerror will NOT do that!
+
+    if (full) {
         return luaL_argerror(L, 1, "no PWMSources available");
     }
-
-    scripting->_pwm_source[scripting->num_pwm_source] = NEW_NOTHROW AP_HAL::PWMSource;
-    if (scripting->_pwm_source[scripting->num_pwm_source] == nullptr) {
+    if (source == nullptr) {
         return luaL_argerror(L, 1, "PWMSources device nullptr");
     }
 
-    *new_AP_HAL__PWMSource(L) = scripting->_pwm_source[scripting->num_pwm_source];
-
-    scripting->num_pwm_source++;
+    *new_AP_HAL__PWMSource(L) = source;
 
     return 1;
 }
@@ -929,12 +977,21 @@ int lua_get_SocketAPM(lua_State *L) {
     if (sock == nullptr) {
         return luaL_argerror(L, 1, "SocketAPM device nullptr");
     }
-    for (uint8_t i=0; i<SCRIPTING_MAX_NUM_NET_SOCKET; i++) {
-        if (scripting->_net_sockets[i] == nullptr) {
-            scripting->_net_sockets[i] = sock;
-            *new_SocketAPM(L) = scripting->_net_sockets[i];
-            return 1;
+    bool stored = false;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
+        for (uint8_t i=0; i<SCRIPTING_MAX_NUM_NET_SOCKET; i++) {
+            if (scripting->_net_sockets[i] == nullptr) {
+                scripting->_net_sockets[i] = sock;
+                stored = true;
+                break;
+            }
         }
+    } // release semaphore here as luaL_argerror will NOT do that!
+
+    if (stored) {
+        *new_SocketAPM(L) = sock;
+        return 1;
     }
 
     return luaL_argerror(L, 1, "no sockets available");
@@ -949,6 +1006,7 @@ int SocketAPM_close(lua_State *L) {
     SocketAPM *ud = *check_SocketAPM(L, 1);
 
     auto *scripting = AP::scripting();
+    WITH_SEMAPHORE(scripting->resource_sem);
 
     // clear allocated socket
     for (uint8_t i=0; i<SCRIPTING_MAX_NUM_NET_SOCKET; i++) {
@@ -1037,19 +1095,24 @@ int SocketAPM_accept(lua_State *L) {
     auto *scripting = AP::scripting();
 
     // find an empty slot
-    for (uint8_t i=0; i<SCRIPTING_MAX_NUM_NET_SOCKET; i++) {
-        if (scripting->_net_sockets[i] == nullptr) {
-            scripting->_net_sockets[i] = ud->accept(0);
+    SocketAPM *sock = nullptr;
+    {
+        WITH_SEMAPHORE(scripting->resource_sem);
+        for (uint8_t i=0; i<SCRIPTING_MAX_NUM_NET_SOCKET; i++) {
             if (scripting->_net_sockets[i] == nullptr) {
-                return 0;
+                sock = ud->accept(0);
+                scripting->_net_sockets[i] = sock;
+                break;
             }
-            *new_SocketAPM(L) = scripting->_net_sockets[i];
-            return 1;
         }
-    }
+    } // release semaphore here as lua errors will NOT do that!
 
-    // out of socket slots, return nil, caller can retry
-    return 0;
+    if (sock == nullptr) {
+        // nothing to accept or out of socket slots, return nil, caller can retry
+        return 0;
+    }
+    *new_SocketAPM(L) = sock;
+    return 1;
 }
 
 /*
@@ -1080,10 +1143,9 @@ int SocketAPM_string_to_ipv4_addr(lua_State *L) {
 #endif // AP_NETWORKING_ENABLED
 
 
-int lua_get_current_env_ref()
+int lua_get_current_env_ref(lua_State *L)
 {
-    auto *scripting = AP::scripting();
-    return scripting->get_current_env_ref();
+    return lua_scripts::get_current_env_ref(L);
 }
 
 // This is used when loading modules with require, lua must only look in enabled directory's
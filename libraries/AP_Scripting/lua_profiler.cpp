@@ -0,0 +1,272 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lua_profiler.h"
+
+#if AP_SCRIPTING_PROFILER_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+bool lua_profiler::init()
+{
+    WITH_SEMAPHORE(sem);
+    if (sites == nullptr) {
+        sites = NEW_NOTHROW site[max_sites];
+    }
+    if (scripts == nullptr) {
+        scripts = NEW_NOTHROW script_stats[max_scripts];
+    }
+    if (sites == nullptr || scripts == nullptr) {
+        delete[] sites;
+        delete[] scripts;
+        sites = nullptr;
+        scripts = nullptr;
+        return false;
+    }
+    num_sites = 0;
+    num_scripts = 0;
+    dropped_steps = 0;
+    dropped_allocs = 0;
+    running_L = nullptr;
+    running_name = nullptr;
+    last_site = nullptr;
+    return true;
+}
+
+void lua_profiler::deinit()
+{
+    WITH_SEMAPHORE(sem);
+    delete[] sites;
+    delete[] scripts;
+    sites = nullptr;
+    scripts = nullptr;
+    running_L = nullptr;
+    running_name = nullptr;
+    last_site = nullptr;
+}
+
+void lua_profiler::set_running(lua_State *L, const char *script_name)
+{
+    WITH_SEMAPHORE(sem);
+    running_L = L;
+    running_name = script_name;
+    last_site = nullptr;
+}
+
+// name of the running script without its directory
+const char *lua_profiler::running_script(void) const
+{
+    const char *name = strrchr(running_name, '/');
+    return (name != nullptr) ? name+1 : running_name;
+}
+
+/*
+  find or add the table entry for the current call stack of L. Must be
+  called with the semaphore held, from the count hook only as it walks
+  the lua stack
+ */
+lua_profiler::site *lua_profiler::find_site(lua_State *L)
+{
+    if (sites == nullptr || running_name == nullptr) {
+        return nullptr;
+    }
+
+    // gather the stack, innermost first
+    lua_Debug ar[max_depth];
+    uint8_t depth = 0;
+    while (depth < max_depth && lua_getstack(L, depth, &ar[depth])) {
+        if (!lua_getinfo(L, "Sln", &ar[depth])) {
+            break;
+        }
+        depth++;
+    }
+
+    // format it outermost first, starting with the script name
+    char stack[sizeof(site::stack)];
+    int len = hal.util->snprintf(stack, sizeof(stack), "%s", running_script());
+    for (int8_t i=depth-1; i>=0; i--) {
+        if (len < 0 || size_t(len) >= sizeof(stack)) {
+            break;
+        }
+        const char *func = ar[i].name != nullptr ? ar[i].name : "?";
+        int ret;
+        if (ar[i].currentline < 0) {
+            // C function or binding
+            ret = hal.util->snprintf(&stack[len], sizeof(stack)-len, ";[C]%s", func);
+        } else {
+            // attribute the innermost frame to the line, callers to their function
+            const int line = (i == 0) ? ar[i].currentline : ar[i].linedefined;
+            ret = hal.util->snprintf(&stack[len], sizeof(stack)-len, ";%s:%d", func, line);
+        }
+        if (ret < 0) {
+            break;
+        }
+        len += ret;
+    }
+
+    return find_site(stack);
+}
+
+/*
+  find or add the table entry for a formatted stack. Must be called
+  with the semaphore held
+ */
+lua_profiler::site *lua_profiler::find_site(const char *stack)
+{
+    if (sites == nullptr) {
+        return nullptr;
+    }
+
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+    for (const char *p = stack; *p != 0; p++) {
+        hash = (hash ^ uint8_t(*p)) * 16777619U;
+    }
+
+    for (uint8_t i=0; i<num_sites; i++) {
+        if (sites[i].hash == hash && strcmp(sites[i].stack, stack) == 0) {
+            return &sites[i];
+        }
+    }
+    if (num_sites >= max_sites) {
+        return nullptr;
+    }
+    site &s = sites[num_sites++];
+    memset(&s, 0, sizeof(s));
+    s.hash = hash;
+    strncpy_noterm(s.stack, stack, sizeof(s.stack)-1);
+    return &s;
+}
+
+void lua_profiler::sample(lua_State *L)
+{
+    WITH_SEMAPHORE(sem);
+    if (L != running_L) {
+        return;
+    }
+    site *s = find_site(L);
+    last_site = s;
+    if (s == nullptr) {
+        dropped_steps += sample_steps;
+        return;
+    }
+    s->steps += sample_steps;
+}
+
+/*
+  called from within the lua allocator, so this must not walk the lua
+  stack or allocate. The allocation is charged to the stack of the last
+  sample, which is at most sample_steps VM instructions old
+ */
+void lua_profiler::record_alloc(size_t size)
+{
+    WITH_SEMAPHORE(sem);
+    if (running_L == nullptr) {
+        // loading scripts or between runs
+        return;
+    }
+    if (last_site == nullptr) {
+        // not sampled yet in this run, charge the script itself
+        last_site = find_site(running_script());
+    }
+    site *s = last_site;
+    if (s == nullptr) {
+        dropped_allocs++;
+        return;
+    }
+    s->allocs++;
+    s->alloc_bytes += size;
+}
+
+void lua_profiler::record_run(const char *script_name, uint32_t run_us, uint32_t gc_us)
+{
+    WITH_SEMAPHORE(sem);
+    if (scripts == nullptr) {
+        return;
+    }
+    const char *name = strrchr(script_name, '/');
+    name = (name != nullptr) ? name+1 : script_name;
+
+    script_stats *stats = nullptr;
+    for (uint8_t i=0; i<num_scripts; i++) {
+        if (strncmp(scripts[i].name, name, sizeof(scripts[i].name)-1) == 0) {
+            stats = &scripts[i];
+            break;
+        }
+    }
+    if (stats == nullptr) {
+        if (num_scripts >= max_scripts) {
+            return;
+        }
+        stats = &scripts[num_scripts++];
+        memset(stats, 0, sizeof(*stats));
+        strncpy_noterm(stats->name, name, sizeof(stats->name)-1);
+    }
+    stats->runs++;
+    stats->run_us_total += run_us;
+    stats->run_us_max = MAX(stats->run_us_max, run_us);
+    stats->gc_us_total += gc_us;
+    stats->gc_us_max = MAX(stats->gc_us_max, gc_us);
+}
+
+/*
+  report in the collapsed stack format of flamegraph.pl, one section
+  for VM steps and one for allocated bytes. Lines starting with # are
+  not stacks and can be filtered out with grep -v
+ */
+void lua_profiler::report(ExpandingString &str)
+{
+    WITH_SEMAPHORE(sem);
+    if (sites == nullptr) {
+        str.printf("# profiler not running, set SCR_PROF_ENABLE to 1 and restart scripts\n");
+        return;
+    }
+
+    str.printf("# VM steps\n");
+    for (uint8_t i=0; i<num_sites; i++) {
+        if (sites[i].steps > 0) {
+            str.printf("%s %u\n", sites[i].stack, unsigned(sites[i].steps));
+        }
+    }
+
+    str.printf("# allocated bytes\n");
+    for (uint8_t i=0; i<num_sites; i++) {
+        if (sites[i].allocs > 0) {
+            str.printf("%s %u\n", sites[i].stack, unsigned(sites[i].alloc_bytes));
+        }
+    }
+
+    if (dropped_steps > 0 || dropped_allocs > 0) {
+        str.printf("# table full, dropped %u steps %u allocations\n", unsigned(dropped_steps), unsigned(dropped_allocs));
+    }
+
+    str.printf("# script runs run_avg_us run_max_us gc_avg_us gc_max_us\n");
+    for (uint8_t i=0; i<num_scripts; i++) {
+        const script_stats &s = scripts[i];
+        str.printf("# %s %u %u %u %u %u\n",
+                   s.name,
+                   unsigned(s.runs),
+                   unsigned(s.run_us_total / MAX(s.runs, 1U)),
+                   unsigned(s.run_us_max),
+                   unsigned(s.gc_us_total / MAX(s.runs, 1U)),
+                   unsigned(s.gc_us_max));
+    }
+}
+
+#endif  // AP_SCRIPTING_PROFILER_ENABLED
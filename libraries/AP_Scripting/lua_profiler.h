@@ -0,0 +1,106 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  sampling profiler for lua scripts. VM steps are attributed to the
+  call stack they happened in and allocations to the last sampled
+  stack. The results are reported as collapsed stacks suitable for
+  flamegraph.pl
+ */
+#pragma once
+
+#include "AP_Scripting_config.h"
+
+#if AP_SCRIPTING_PROFILER_ENABLED
+
+#include <AP_HAL/Semaphores.h>
+#include <AP_Common/ExpandingString.h>
+
+#include "lua/src/lua.hpp"
+
+class lua_profiler
+{
+public:
+    // allocate and clear tables, returns false on failure. Tables are
+    // kept off the scripting heap so results survive scripts stopping
+    bool init();
+
+    // free tables
+    void deinit();
+
+    bool enabled() const { return sites != nullptr; }
+
+    // set the state and name of the script about to run, nullptr when no script is running
+    void set_running(lua_State *L, const char *script_name);
+
+    // record a sample of sample_steps VM instructions in the running function
+    void sample(lua_State *L);
+
+    // record an allocation of size bytes by the running script
+    void record_alloc(size_t size);
+
+    // record the run time of a script and the full GC that followed it
+    void record_run(const char *script_name, uint32_t run_us, uint32_t gc_us);
+
+    // produce a text report, collapsed stacks followed by per-script times
+    void report(ExpandingString &str);
+
+    // number of VM instructions per sample
+    static const uint16_t sample_steps = 100;
+
+private:
+    // a unique call stack, formatted as "script;func:line;func:line"
+    struct site {
+        uint32_t hash;
+        uint32_t steps;
+        uint32_t allocs;
+        uint32_t alloc_bytes;
+        char stack[96];
+    };
+    static const uint8_t max_sites = 48;
+    static const uint8_t max_depth = 6;
+
+    struct script_stats {
+        char name[32];
+        uint32_t runs;
+        uint32_t run_us_total;
+        uint32_t run_us_max;
+        uint32_t gc_us_total;
+        uint32_t gc_us_max;
+    };
+    static const uint8_t max_scripts = 16;
+
+    site *find_site(lua_State *L);
+    site *find_site(const char *stack);
+    const char *running_script(void) const;
+
+    site *sites;
+    uint8_t num_sites;
+    script_stats *scripts;
+    uint8_t num_scripts;
+
+    // samples that did not fit in the table
+    uint32_t dropped_steps;
+    uint32_t dropped_allocs;
+
+    lua_State *running_L;
+    const char *running_name;
+
+    // site of the last sample in this run, allocations are charged to it
+    site *last_site;
+
+    HAL_Semaphore sem;
+};
+
+#endif  // AP_SCRIPTING_PROFILER_ENABLED
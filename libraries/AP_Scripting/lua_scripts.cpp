@@ -29,8 +29,6 @@
 extern const AP_HAL::HAL& hal;
 #define ENABLE_DEBUG_MODULE 0
 
-bool lua_scripts::overtime;
-jmp_buf lua_scripts::panic_jmp;
 char *lua_scripts::error_msg_buf;
 HAL_Semaphore lua_scripts::error_msg_buf_sem;
 uint8_t lua_scripts::print_error_count;
@@ -40,20 +38,64 @@ uint32_t lua_scripts::loaded_checksum;
 uint32_t lua_scripts::running_checksum;
 HAL_Semaphore lua_scripts::crc_sem;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options)
-    : _vm_steps(vm_steps),
+#if AP_SCRIPTING_PROFILER_ENABLED
+lua_profiler lua_scripts::profilers[AP_SCRIPTING_MAX_THREADS];
+#endif
+
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int16 &gc_budget_us, AP_Int8 &debug_options, bool profile, uint8_t thread_index)
+    : _thread_index(thread_index),
+      _vm_steps(vm_steps),
+      _gc_budget_us(gc_budget_us),
       _debug_options(debug_options)
+#if AP_SCRIPTING_PROFILER_ENABLED
+      , profiler(profilers[thread_index])
+#endif
 {
     const bool allow_heap_expansion = !option_is_set(AP_Scripting::DebugOption::DISABLE_HEAP_EXPANSION);
-    _heap.create(heap_size, 10, allow_heap_expansion, 20*1024);
+    _heap.create(heap_size, 10, allow_heap_expansion, 20*1024, AP_SCRIPTING_HEAP_POOLS_ENABLED);
+
+#if AP_SCRIPTING_PROFILER_ENABLED
+    if (!profile) {
+        profiler.deinit();
+    } else if (!profiler.init()) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Lua: Unable to allocate profiler");
+    }
+#endif
 }
 
 lua_scripts::~lua_scripts() {
     _heap.destroy();
 }
 
+lua_scripts *lua_scripts::get_instance(lua_State *L) {
+    void *ud = nullptr;
+    lua_getallocf(L, &ud);
+    return (lua_scripts *)ud;
+}
+
+int lua_scripts::get_current_env_ref(lua_State *L) {
+    return get_instance(L)->current_env_ref;
+}
+
+bool lua_scripts::is_primary_state(lua_State *L) {
+    return get_instance(L)->_thread_index == 0;
+}
+
 void lua_scripts::hook(lua_State *L, lua_Debug *ar) {
-    lua_scripts::overtime = true;
+    lua_scripts *lua = get_instance(L);
+
+#if AP_SCRIPTING_PROFILER_ENABLED
+    if (lua->profiler.enabled() && !lua->overtime) {
+        // sample the stack, only bail out once the full vm_steps have been used
+        lua->profiler.sample(L);
+        lua->profile_steps_remaining -= lua_profiler::sample_steps;
+        if (lua->profile_steps_remaining > 0) {
+            return;
+        }
+    }
+#endif
+
+    lua->overtime = true;
 
     // we need to aggressively bail out as we are over time
     // so we will aggressively trap errors until we clear out
@@ -78,10 +120,8 @@ void lua_scripts::set_and_print_new_error_message(MAV_SEVERITY severity, const c
 
     // reset buffer and print count
     print_error_count = 0;
-    if (error_msg_buf) {
-        _heap.deallocate(error_msg_buf);
-        error_msg_buf = nullptr;
-    }
+    delete[] error_msg_buf;
+    error_msg_buf = nullptr;
 
     // generate va_list and create a copy
     va_list arg_list, arg_list_copy;
@@ -101,8 +141,9 @@ void lua_scripts::set_and_print_new_error_message(MAV_SEVERITY severity, const c
         return;
     }
 
-    // allocate buffer on scripting heap
-    error_msg_buf = (char *)_heap.allocate(len+1);
+    // allocate buffer, this is shared by all scripting threads so is
+    // not on a scripting heap
+    error_msg_buf = NEW_NOTHROW char[len+1];
     if (!error_msg_buf) {
         // allocation failed
         va_end(arg_list);
@@ -123,7 +164,7 @@ void lua_scripts::set_and_print_new_error_message(MAV_SEVERITY severity, const c
 
 int lua_scripts::atpanic(lua_State *L) {
     set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Panic: %s", lua_tostring(L, -1));
-    longjmp(panic_jmp, 1);
+    longjmp(get_instance(L)->panic_jmp, 1);
     return 0;
 }
 
@@ -157,8 +198,77 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
 #endif // HAL_LOGGING_ENABLED
 }
 
+/*
+  garbage collect after a script run. With no time budget a full
+  collection is done, otherwise incremental steps are run until the
+  budget is used or the cycle completes
+ */
+uint32_t lua_scripts::collect_garbage(lua_State *L)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    bool cycle_complete;
+    uint32_t now_us;
+    if (_gc_budget_us <= 0) {
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        cycle_complete = true;
+        now_us = AP_HAL::micros();
+    } else {
+        do {
+            cycle_complete = lua_gc(L, LUA_GCSTEP, 0) != 0;
+            now_us = AP_HAL::micros();
+        } while (!cycle_complete && (now_us - start_us) < uint32_t(_gc_budget_us.get()));
+    }
+
+    const uint32_t dt = now_us - start_us;
+    gc_stats.cycle_us += dt;
+    gc_stats.max_step_us = MAX(gc_stats.max_step_us, dt);
+    if (cycle_complete) {
+        gc_stats.cycles++;
+        gc_stats.last_cycle_us = gc_stats.cycle_us;
+        gc_stats.cycle_us = 0;
+    }
+    return dt;
+}
+
+/*
+  send heap and garbage collection statistics to the GCS
+ */
+void lua_scripts::send_heap_stats()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_heap_stats_ms < 5000) {
+        return;
+    }
+    last_heap_stats_ms = now_ms;
+
+    MultiHeap::Stats stats;
+    _heap.get_stats(stats);
+    // fragmentation is the part of the free memory that can't be used for the largest allocation
+    const uint32_t frag_pct = stats.free > 0 ? 100U - uint32_t((uint64_t(stats.largest_free) * 100U) / stats.free) : 0;
+    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Heap %u free %u largest %u frag %u%%",
+                  unsigned(stats.heap_size),
+                  unsigned(stats.free),
+                  unsigned(stats.largest_free),
+                  unsigned(frag_pct));
+    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Pool %u/%u GC %u cycles %uus/cycle max %uus",
+                  unsigned(stats.pool_used),
+                  unsigned(stats.pool_size),
+                  unsigned(gc_stats.cycles),
+                  unsigned(gc_stats.last_cycle_us),
+                  unsigned(gc_stats.max_step_us));
+    gc_stats.max_step_us = 0;
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // only files ending in .luac may be precompiled
+    const char *mode = "t";
+#if LUA_SUPPORT_LOAD_BINARY
+    const size_t length = strlen(filename);
+    if ((length > 5) && (strcmp(&filename[length-5], ".luac") == 0)) {
+        mode = "b";
+    }
+#endif
+    if (int error = luaL_loadfilex(L, filename, mode)) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Error: %s", lua_tostring(L, -1));
@@ -266,7 +376,7 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
         return;
     }
 
-    // load anything that ends in .lua
+    // load anything that ends in .lua, or .luac if precompiled scripts are supported
     for (struct dirent *de=AP::FS().readdir(d); de; de=AP::FS().readdir(d)) {
         uint8_t length = strlen(de->d_name);
         if (length < 5) {
@@ -274,8 +384,12 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
             continue;
         }
 
-        if ((de->d_name[0] == '.') || strncmp(&de->d_name[length-4], ".lua", 4)) {
-            // starts with . (hidden file) or doesn't end in .lua
+        bool is_script = strncmp(&de->d_name[length-4], ".lua", 4) == 0;
+#if LUA_SUPPORT_LOAD_BINARY
+        is_script |= (length > 5) && (strncmp(&de->d_name[length-5], ".luac", 5) == 0);
+#endif
+        if ((de->d_name[0] == '.') || !is_script) {
+            // starts with . (hidden file) or isn't a script
             continue;
         }
 
@@ -308,6 +422,13 @@ void lua_scripts::reset_loop_overtime(lua_State *L) {
     overtime = false;
     // reset the hook to clear the counter
     const int32_t vm_steps = MAX(_vm_steps, 1000);
+#if AP_SCRIPTING_PROFILER_ENABLED
+    if (profiler.enabled()) {
+        profile_steps_remaining = vm_steps;
+        lua_sethook(L, hook, LUA_MASKCOUNT, lua_profiler::sample_steps);
+        return;
+    }
+#endif
     lua_sethook(L, hook, LUA_MASKCOUNT, vm_steps);
 }
 
@@ -333,7 +454,7 @@ void lua_scripts::run_next_script(lua_State *L) {
     // pop the function to the top of the stack
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->run_ref);
     // set current environment for other users
-    AP::scripting()->set_current_env_ref(script->env_ref);
+    current_env_ref = script->env_ref;
 
     if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
         if (overtime) {
@@ -458,11 +579,20 @@ void lua_scripts::reschedule_script(script_info *script) {
     previous->next = script;
 }
 
-MultiHeap lua_scripts::_heap;
-
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
-    (void)ud; /* not used */
-    return _heap.change_size(ptr, osize, nsize);
+    lua_scripts *lua = (lua_scripts *)ud;
+#if AP_SCRIPTING_PROFILER_ENABLED
+    if (lua->profiler.enabled()) {
+        // osize is the object type for new allocations, attribute
+        // growth before change_size can move the lua stack
+        if (ptr == nullptr) {
+            lua->profiler.record_alloc(nsize);
+        } else if (nsize > osize) {
+            lua->profiler.record_alloc(nsize - osize);
+        }
+    }
+#endif
+    return lua->_heap.change_size(ptr, osize, nsize);
 }
 
 void lua_scripts::run(void) {
@@ -478,6 +608,9 @@ void lua_scripts::run(void) {
         if (!succeeded_initial_load) {
             return;
         }
+#if AP_SCRIPTING_PROFILER_ENABLED
+        profiler.set_running(nullptr, nullptr);
+#endif
         if (lua_state != nullptr) {
             lua_close(lua_state); // shutdown the old state
         }
@@ -489,7 +622,7 @@ void lua_scripts::run(void) {
         overtime = false;
     }
 
-    lua_state = lua_newstate(alloc, NULL);
+    lua_state = lua_newstate(alloc, this);
     lua_State *L = lua_state;
     if (L == nullptr) {
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Lua: Couldn't allocate a lua state");
@@ -523,16 +656,23 @@ void lua_scripts::run(void) {
     uint16_t dir_disable = AP_Scripting::get_singleton()->get_disabled_dir();
     bool loaded = false;
     if ((dir_disable & uint16_t(AP_Scripting::SCR_DIR::SCRIPTS)) == 0) {
-        load_all_scripts_in_dir(L, SCRIPTING_DIRECTORY);
+        if (_thread_index == 0) {
+            load_all_scripts_in_dir(L, SCRIPTING_DIRECTORY);
+        } else {
+            // other threads only run the scripts in their own subdirectory
+            char dirname[sizeof(SCRIPTING_DIRECTORY) + 10];
+            hal.util->snprintf(dirname, sizeof(dirname), SCRIPTING_DIRECTORY "/thread%u", unsigned(_thread_index));
+            load_all_scripts_in_dir(L, dirname);
+        }
         loaded = true;
     }
 #ifdef HAL_HAVE_AP_ROMFS_EMBEDDED_LUA
-    if ((dir_disable & uint16_t(AP_Scripting::SCR_DIR::ROMFS)) == 0) {
+    if ((_thread_index == 0) && (dir_disable & uint16_t(AP_Scripting::SCR_DIR::ROMFS)) == 0) {
         load_all_scripts_in_dir(L, "@ROMFS/scripts");
         loaded = true;
     }
 #endif
-    if (!loaded) {
+    if (!loaded && (_thread_index == 0)) {
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Lua: All directory's disabled see SCR_DIR_DISABLE");
     }
 
@@ -581,6 +721,9 @@ void lua_scripts::run(void) {
 #endif
 
             const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+#if AP_SCRIPTING_PROFILER_ENABLED
+            profiler.set_running(L, script_name);
+#endif
             const uint32_t loadEnd = AP_HAL::micros();
 
             // NOTE!  the base pointer of our scripts linked list,
@@ -590,6 +733,9 @@ void lua_scripts::run(void) {
             run_next_script(L);
 
             const uint32_t runEnd = AP_HAL::micros();
+#if AP_SCRIPTING_PROFILER_ENABLED
+            profiler.set_running(nullptr, nullptr);
+#endif
             const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
@@ -600,7 +746,18 @@ void lua_scripts::run(void) {
 
 
             // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
-            lua_gc(L, LUA_GCCOLLECT, 0);
+#if AP_SCRIPTING_PROFILER_ENABLED
+            const uint32_t gc_time = collect_garbage(L);
+            if (profiler.enabled()) {
+                profiler.record_run(script_name, runEnd - loadEnd, gc_time);
+            }
+#else
+            collect_garbage(L);
+#endif
+
+            if (option_is_set(AP_Scripting::DebugOption::RUNTIME_MSG)) {
+                send_heap_stats();
+            }
 
         } else {
             if (option_is_set(AP_Scripting::DebugOption::NO_SCRIPTS_TO_RUN)) {
@@ -622,7 +779,7 @@ void lua_scripts::run(void) {
 
         // re-print the latest error message every 10 seconds 10 times
         const uint8_t error_prints = 10;
-        if ((print_error_count < error_prints) && (AP_HAL::millis() - last_print_ms > 10000)) {
+        if ((_thread_index == 0) && (print_error_count < error_prints) && (AP_HAL::millis() - last_print_ms > 10000)) {
             // note that we do not clear the buffer after we have finished printing, this allows it to be used for a pre-arm check
             print_error(MAV_SEVERITY_DEBUG);
             print_error_count++;
@@ -639,12 +796,12 @@ void lua_scripts::run(void) {
         lua_state = nullptr;
     }
 
-    error_msg_buf_sem.take_blocking();
-    if (error_msg_buf != nullptr) {
-        _heap.deallocate(error_msg_buf);
+    if (_thread_index == 0) {
+        error_msg_buf_sem.take_blocking();
+        delete[] error_msg_buf;
         error_msg_buf = nullptr;
+        error_msg_buf_sem.give();
     }
-    error_msg_buf_sem.give();
 }
 
 // Return the file checksums of running and loaded scripts
@@ -660,4 +817,20 @@ uint32_t lua_scripts::get_running_checksum()
     return running_checksum;
 }
 
+#if AP_SCRIPTING_PROFILER_ENABLED
+void lua_scripts::profile_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(profilers); i++) {
+        // thread 0 is always reported to give instructions when not running
+        if ((i > 0) && !profilers[i].enabled()) {
+            continue;
+        }
+        if (ARRAY_SIZE(profilers) > 1) {
+            str.printf("# thread %u\n", unsigned(i));
+        }
+        profilers[i].report(str);
+    }
+}
+#endif
+
 #endif  // AP_SCRIPTING_ENABLED
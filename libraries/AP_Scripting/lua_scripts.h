@@ -28,13 +28,16 @@
 #include <AP_HAL/Semaphores.h>
 #include <AP_MultiHeap/AP_MultiHeap.h>
 #include "lua_common_defs.h"
+#include "lua_profiler.h"
 
 #include "lua/src/lua.hpp"
 
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options);
+    // thread_index 0 runs the scripts in the main scripts directory
+    // and ROMFS, other threads run the scripts in their own subdirectory
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int16 &gc_budget_us, AP_Int8 &debug_options, bool profile, uint8_t thread_index);
 
     ~lua_scripts();
 
@@ -46,7 +49,13 @@ public:
     // run scripts, does not return unless an error occured
     void run(void);
 
-    static bool overtime; // script exceeded it's execution slot, and we are bailing out
+    bool overtime; // script exceeded it's execution slot, and we are bailing out
+
+    // get the environment of the script running on a state, for require
+    static int get_current_env_ref(lua_State *L);
+
+    // true if the state is run by the main scripting thread
+    static bool is_primary_state(lua_State *L);
 
 private:
 
@@ -82,11 +91,17 @@ private:
 
     // lua panic handler, will jump back to the start of run
     static int atpanic(lua_State *L);
-    static jmp_buf panic_jmp;
+    jmp_buf panic_jmp;
+
+    // find the instance that owns a state, it is passed to lua as the allocator userdata
+    static lua_scripts *get_instance(lua_State *L);
 
     lua_State *lua_state;
+    const uint8_t _thread_index;
+    int current_env_ref;
 
     const AP_Int32 & _vm_steps;
+    const AP_Int16 & _gc_budget_us;
     AP_Int8 & _debug_options;
 
     bool option_is_set(AP_Scripting::DebugOption option) const {
@@ -95,12 +110,27 @@ private:
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 
-    static MultiHeap _heap;
+    MultiHeap _heap;
 
     // helper for print and log of runtime stats
     void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
 
-    // must be static for use in atpanic
+    // garbage collect after a script run, returns time taken in microseconds
+    uint32_t collect_garbage(lua_State *L);
+
+    // garbage collection statistics
+    struct {
+        uint32_t cycles;        // completed collection cycles
+        uint32_t cycle_us;      // time spent in the current cycle
+        uint32_t last_cycle_us; // time spent in the last complete cycle
+        uint32_t max_step_us;   // longest time spent after a single script run
+    } gc_stats;
+
+    // send heap and garbage collection statistics to the GCS
+    void send_heap_stats();
+    uint32_t last_heap_stats_ms;
+
+    // shared by all scripting threads
     static void print_error(MAV_SEVERITY severity);
     static char *error_msg_buf;
     static HAL_Semaphore error_msg_buf_sem;
@@ -112,6 +142,15 @@ private:
     static uint32_t running_checksum;
     static HAL_Semaphore crc_sem;
 
+#if AP_SCRIPTING_PROFILER_ENABLED
+    // one profiler per thread, kept after the thread stops
+    static lua_profiler profilers[AP_SCRIPTING_MAX_THREADS];
+    lua_profiler &profiler;
+    // VM steps left before the script is overtime, the hook runs more
+    // often than vm_steps when profiling
+    int32_t profile_steps_remaining;
+#endif
+
 public:
     // must be static for use in atpanic, public to allow bindings to issue none fatal warnings
     static void set_and_print_new_error_message(MAV_SEVERITY severity, const char *fmt, ...) FMT_PRINTF(2,3);
@@ -126,6 +165,11 @@ public:
     static uint32_t get_loaded_checksum();
     static uint32_t get_running_checksum();
 
+#if AP_SCRIPTING_PROFILER_ENABLED
+    // profiler report for @SYS/lua_profile.txt
+    static void profile_info(ExpandingString &str);
+#endif
+
 };
 
 #endif  // AP_SCRIPTING_ENABLED
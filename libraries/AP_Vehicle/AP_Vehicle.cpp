@@ -861,8 +861,9 @@ void AP_Vehicle::update_dynamic_notch(AP_InertialSensor::HarmonicNotch &notch)
             // set the harmonic notch filter frequency scaled on measured frequency
             if (notch.params.hasOption(HarmonicNotchFilterParams::Options::DynamicHarmonic)) {
                 float notches[INS_MAX_NOTCHES];
-                // ESC telemetry will return 0 for missing data, but only after 1s
-                const uint8_t num_notches = AP::esc_telem().get_motor_frequencies_hz(INS_MAX_NOTCHES, notches);
+                // ESC telemetry will return 0 for missing data, but only after 1s. The
+                // frequencies are interpolated to the time of the latest gyro sample
+                const uint8_t num_notches = AP::esc_telem().get_motor_frequencies_hz_at(ins.get_last_update_usec(), INS_MAX_NOTCHES, notches);
                 if (num_notches > 0) {
                     notch.update_frequencies_hz(num_notches, notches);
                 } else {    // throttle fallback
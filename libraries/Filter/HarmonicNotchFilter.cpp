@@ -25,13 +25,6 @@
 
 #define HNF_MAX_FILTERS HAL_HNF_MAX_FILTERS // must be even for double-notch filters
 
-/*
-  optional logging for SITL only of all notch frequencies
- */
-#ifndef NOTCH_DEBUG_LOGGING
-#define NOTCH_DEBUG_LOGGING 0
-#endif
-
 #if NOTCH_DEBUG_LOGGING
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -425,6 +418,59 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
     return output;
 }
 
+#if !NOTCH_DEBUG_LOGGING
+/*
+  the gyro notches run for every IMU at the sensor rate, so for
+  Vector3f the cascade is run here rather than with a call to
+  NotchFilter::apply() per notch. Each notch loads its coefficients
+  once and updates all three axes in place, which lets the compiler
+  keep the axes in registers or vectorise them. The arithmetic is the
+  same as NotchFilter::apply() so the output is unchanged
+ */
+template <>
+Vector3f HarmonicNotchFilter<Vector3f>::apply(const Vector3f &sample)
+{
+    if (!_initialised) {
+        return sample;
+    }
+
+    float output[3] { sample.x, sample.y, sample.z };
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        NotchFilter<Vector3f> &notch = _filters[i];
+        if (!notch.initialised || notch.need_reset) {
+            // pass through and prime the delayed samples, as NotchFilter::apply()
+            const Vector3f in { output[0], output[1], output[2] };
+            notch.signal1 = in;
+            notch.signal2 = in;
+            notch.ntchsig1 = in;
+            notch.ntchsig2 = in;
+            notch.need_reset = false;
+            continue;
+        }
+
+        const float b0 = notch.b0;
+        const float b1 = notch.b1;
+        const float b2 = notch.b2;
+        const float a1 = notch.a1;
+        const float a2 = notch.a2;
+        float *ntchsig1 = &notch.ntchsig1.x;
+        float *ntchsig2 = &notch.ntchsig2.x;
+        float *signal1 = &notch.signal1.x;
+        float *signal2 = &notch.signal2.x;
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            const float in = output[axis];
+            const float out = in*b0 + ntchsig1[axis]*b1 + ntchsig2[axis]*b2 - signal1[axis]*a1 - signal2[axis]*a2;
+            ntchsig2[axis] = ntchsig1[axis];
+            ntchsig1[axis] = in;
+            signal2[axis] = signal1[axis];
+            signal1[axis] = out;
+            output[axis] = out;
+        }
+    }
+    return Vector3f{output[0], output[1], output[2]};
+}
+#endif  // NOTCH_DEBUG_LOGGING
+
 /*
   reset all of the underlying filters
  */
@@ -21,6 +21,13 @@
 
 #define HNF_MAX_HARMONICS 16
 
+/*
+  optional logging for SITL only of all notch frequencies
+ */
+#ifndef NOTCH_DEBUG_LOGGING
+#define NOTCH_DEBUG_LOGGING 0
+#endif
+
 class HarmonicNotchFilterParams;
 
 /*
@@ -179,5 +186,11 @@ private:
     AP_Float _freq_min_ratio;
 };
 
+#if !NOTCH_DEBUG_LOGGING
+// the gyro notch cascade has its own implementation for speed
+template <>
+Vector3f HarmonicNotchFilter<Vector3f>::apply(const Vector3f &sample);
+#endif
+
 typedef HarmonicNotchFilter<Vector3f> HarmonicNotchFilterVector3f;
 
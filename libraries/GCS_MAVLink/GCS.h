@@ -507,6 +507,11 @@ protected:
     // saveable rate of each stream
     AP_Int16        streamRates[NUM_STREAMS];
 
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    // percentage of the link bandwidth streamed messages may use, 0 disables
+    AP_Int8         bw_pct;
+#endif
+
     void handle_heartbeat(const mavlink_message_t &msg) const;
 
     virtual bool persist_streamrates() const { return false; }
@@ -812,6 +817,35 @@ private:
     // number of extra ms to add to slow things down for the radio
     uint16_t         stream_slowdown_ms;
 
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    // token bucket pacing streamed messages within the link
+    // bandwidth.  Allocated when MAVn_BW_PCT is set, and replaces
+    // stream_slowdown_ms as the RADIO_STATUS flow control
+    struct BandwidthScheduler {
+        float tokens;               // bytes which may be sent now
+        float capacity_scale = 1;   // backoff from RADIO_STATUS and full tx buffer
+        uint32_t last_update_us;
+        uint32_t last_bytes_sent;   // comm_get_bytes_sent() already charged
+        uint32_t last_tx_full_ms;
+        uint32_t window_start_ms;
+        uint32_t window_bytes;
+        uint16_t deferred;          // stream sends held back this window
+        uint16_t last_size[MSG_LAST];   // bytes of the last send of each message
+        uint32_t msg_bytes[MSG_LAST];   // bytes sent this window
+        uint16_t msg_count[MSG_LAST];   // sends this window
+    } *bw_sched;
+
+    void bw_sched_update();
+    uint32_t bw_sched_rate() const;
+    bool bw_sched_allow(ap_message id);
+    void bw_sched_sent(ap_message id, uint32_t nbytes);
+    void bw_sched_tx_full();
+    void bw_sched_radio_status(uint8_t txbuf);
+#if HAL_LOGGING_ENABLED
+    void log_bw_sched_stats();
+#endif
+#endif  // AP_MAVLINK_BW_SCHEDULER_ENABLED
+
     // outbound ("deferred message") queue.
 
     // "special" messages such as heartbeat, next_param etc are stored
@@ -0,0 +1,227 @@
+/*
+   GCS MAVLink bandwidth scheduling of streamed messages
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GCS_config.h"
+
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "GCS.h"
+#include <AP_Logger/AP_Logger.h>
+
+extern const AP_HAL::HAL& hal;
+
+// size assumed for a message we have not sent yet
+#define BW_SCHED_DEFAULT_PAYLOAD 32
+
+/*
+  bytes per second streamed messages may use on this link
+ */
+uint32_t GCS_MAVLINK::bw_sched_rate() const
+{
+    const float rate = _port->bw_in_bytes_per_second() * bw_pct.get() * 0.01f * bw_sched->capacity_scale;
+    return MAX(uint32_t(rate), 1U);
+}
+
+/*
+  refill the token bucket, called at the start of each update_send()
+ */
+void GCS_MAVLINK::bw_sched_update()
+{
+    if (bw_pct.get() <= 0) {
+        if (bw_sched != nullptr) {
+            delete bw_sched;
+            bw_sched = nullptr;
+        }
+        return;
+    }
+    if (bw_sched == nullptr) {
+        bw_sched = NEW_NOTHROW BandwidthScheduler;
+        if (bw_sched == nullptr) {
+            return;
+        }
+        bw_sched->last_update_us = AP_HAL::micros();
+        bw_sched->last_bytes_sent = comm_get_bytes_sent(chan);
+        bw_sched->window_start_ms = AP_HAL::millis();
+        // the token bucket takes over flow control from RADIO_STATUS
+        stream_slowdown_ms = 0;
+    }
+
+    BandwidthScheduler &s = *bw_sched;
+    const uint32_t now_us = AP_HAL::micros();
+    const float dt = MIN(now_us - s.last_update_us, 1000000U) * 1.0e-6f;
+    s.last_update_us = now_us;
+
+    // recover from any backoff at 2% per second
+    s.capacity_scale = MIN(s.capacity_scale + 0.02f * dt, 1.0f);
+
+    // anything written outside do_try_send_message (parameters, FTP,
+    // statustext, routed packets) also uses the link
+    const uint32_t bytes_sent = comm_get_bytes_sent(chan);
+    const uint32_t unaccounted = bytes_sent - s.last_bytes_sent;
+    s.last_bytes_sent = bytes_sent;
+    s.window_bytes += unaccounted;
+
+    // allow a burst of 100ms worth of data, and at least one full
+    // packet so large messages can go on slow links
+    const uint32_t rate = bw_sched_rate();
+    const float burst = MAX(rate * 0.1f, float(MAVLINK_MAX_PACKET_LEN));
+    s.tokens += rate * dt - unaccounted;
+    s.tokens = constrain_float(s.tokens, -burst, burst);
+}
+
+/*
+  return true if a streamed message may be sent now
+ */
+bool GCS_MAVLINK::bw_sched_allow(ap_message id)
+{
+    if (bw_sched == nullptr) {
+        return true;
+    }
+    uint16_t size = bw_sched->last_size[id];
+    if (size == 0) {
+        size = packet_overhead() + BW_SCHED_DEFAULT_PAYLOAD;
+    }
+    if (bw_sched->tokens >= size) {
+        return true;
+    }
+    bw_sched->deferred++;
+    return false;
+}
+
+/*
+  charge a sent message against the bucket and record its size
+ */
+void GCS_MAVLINK::bw_sched_sent(ap_message id, uint32_t nbytes)
+{
+    if (bw_sched == nullptr || nbytes == 0) {
+        return;
+    }
+    BandwidthScheduler &s = *bw_sched;
+    s.tokens -= nbytes;
+    s.last_bytes_sent += nbytes;
+    s.window_bytes += nbytes;
+    s.last_size[id] = MIN(nbytes, uint32_t(UINT16_MAX));
+    s.msg_bytes[id] += nbytes;
+    s.msg_count[id]++;
+}
+
+/*
+  the port transmit buffer filled, the link is slower than the
+  baudrate suggests
+ */
+void GCS_MAVLINK::bw_sched_tx_full()
+{
+    if (bw_sched == nullptr) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - bw_sched->last_tx_full_ms < 100) {
+        return;
+    }
+    bw_sched->last_tx_full_ms = now_ms;
+    bw_sched->capacity_scale = MAX(bw_sched->capacity_scale * 0.9f, 0.1f);
+}
+
+/*
+  adapt to the radio's transmit buffer, as reported in RADIO_STATUS
+ */
+void GCS_MAVLINK::bw_sched_radio_status(uint8_t txbuf)
+{
+    float &scale = bw_sched->capacity_scale;
+    if (txbuf < 20) {
+        // we are very low on space - slow down a lot
+        scale *= 0.8f;
+    } else if (txbuf < 50) {
+        // we are a bit low on space, slow down slightly
+        scale *= 0.95f;
+    } else if (txbuf > 95) {
+        // the buffer has plenty of space, speed up
+        scale += 0.05f;
+    }
+    scale = constrain_float(scale, 0.1f, 1.0f);
+}
+
+#if HAL_LOGGING_ENABLED
+/*
+  record bandwidth use of this link, once per second
+ */
+void GCS_MAVLINK::log_bw_sched_stats()
+{
+    if (bw_sched == nullptr) {
+        return;
+    }
+    BandwidthScheduler &s = *bw_sched;
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = MAX(now_ms - s.window_start_ms, 1U);
+    const uint64_t now_us = AP_HAL::micros64();
+
+// @LoggerMessage: MAVB
+// @Description: MAVLink stream bandwidth scheduler
+// @Field: TimeUS: Time since system startup
+// @Field: chan: mavlink channel number
+// @Field: Cap: bytes per second streams may use
+// @Field: Scl: backoff applied to the configured bandwidth
+// @Field: BPS: bytes per second sent on the link
+// @Field: Def: streamed messages held back for lack of bandwidth
+    AP::logger().WriteStreaming(
+        "MAVB",
+        "TimeUS,chan,Cap,Scl,BPS,Def",
+        "s#B-B-",
+        "F-0-0-",
+        "QBIfIH",
+        now_us,
+        uint8_t(chan),
+        bw_sched_rate(),
+        s.capacity_scale,
+        uint32_t(uint64_t(s.window_bytes) * 1000U / dt_ms),
+        s.deferred);
+
+    for (uint16_t id=0; id<MSG_LAST; id++) {
+        if (s.msg_count[id] == 0) {
+            continue;
+        }
+// @LoggerMessage: MAVM
+// @Description: MAVLink bandwidth use per message
+// @Field: TimeUS: Time since system startup
+// @Field: chan: mavlink channel number
+// @Field: Id: ap_message id
+// @Field: BPS: bytes per second sent
+// @Field: Cnt: number of times sent
+        AP::logger().WriteStreaming(
+            "MAVM",
+            "TimeUS,chan,Id,BPS,Cnt",
+            "s#-B-",
+            "F-0-0",
+            "QBHIH",
+            now_us,
+            uint8_t(chan),
+            id,
+            uint32_t(uint64_t(s.msg_bytes[id]) * 1000U / dt_ms),
+            s.msg_count[id]);
+        s.msg_bytes[id] = 0;
+        s.msg_count[id] = 0;
+    }
+
+    s.window_start_ms = now_ms;
+    s.window_bytes = 0;
+    s.deferred = 0;
+}
+#endif  // HAL_LOGGING_ENABLED
+
+#endif  // AP_MAVLINK_BW_SCHEDULER_ENABLED
@@ -880,6 +880,12 @@ void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg)
     // use the state of the transmit buffer in the radio to
     // control the stream rate, giving us adaptive software
     // flow control
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    if (bw_sched != nullptr) {
+        // the token bucket rate adapts instead of stream intervals
+        bw_sched_radio_status(packet.txbuf);
+    } else
+#endif
     if (packet.txbuf < 20 && stream_slowdown_ms < 2000) {
         // we are very low on space - slow down a lot
         stream_slowdown_ms += 60;
@@ -1262,6 +1268,16 @@ void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
             sending_bucket_id = i;
             ms_before_send_next_bucket_to_send = ms_before_send_this_bucket;
         }
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+        else if (bw_sched != nullptr &&
+                 ms_before_send_this_bucket == 0 &&
+                 interval > get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id])) {
+            // several buckets are overdue as the link is saturated;
+            // send the slowest first so high rate streams do not
+            // starve low rate status messages
+            sending_bucket_id = i;
+        }
+#endif
     }
     if (sending_bucket_id != no_bucket_to_send) {
         bucket_message_ids_to_send = deferred_message_bucket[sending_bucket_id].ap_message_ids;
@@ -1316,6 +1332,9 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
         return false;
     }
     WITH_SEMAPHORE(comm_chan_lock(chan));
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    const uint32_t bytes_sent_before = comm_get_bytes_sent(chan);
+#endif
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     void *data = hal.scheduler->disable_interrupts_save();
     uint32_t start_send_message_us = AP_HAL::micros();
@@ -1335,6 +1354,9 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
         try_send_message_stats.longest_time_us = delta_us;
         try_send_message_stats.longest_id = id;
     }
+#endif
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    bw_sched_sent(id, comm_get_bytes_sent(chan) - bytes_sent_before);
 #endif
     return true;
 }
@@ -1537,6 +1559,10 @@ void GCS_MAVLINK::update_send()
     // check for any in-progress tasks; check_tasks does its own rate-limiting
     GCS_MAVLINK_InProgress::check_tasks();
 
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    bw_sched_update();
+#endif
+
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
@@ -1601,7 +1627,16 @@ void GCS_MAVLINK::update_send()
 
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+            if (!bw_sched_allow(next)) {
+                // streams wait for the bucket to refill
+                break;
+            }
+#endif
             if (!do_try_send_message(next)) {
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+                bw_sched_tx_full();
+#endif
                 break;
             }
             bucket_message_ids_to_send.clear(next);
@@ -1957,6 +1992,9 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
     if (is_active() || is_streaming()) {
         if (tnow - last_mavlink_stats_logged > 1000) {
             log_mavlink_stats();
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+            log_bw_sched_stats();
+#endif
             last_mavlink_stats_logged = tnow;
         }
     }
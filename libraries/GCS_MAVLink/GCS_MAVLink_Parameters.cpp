@@ -202,6 +202,17 @@ const AP_Param::GroupInfo GCS_MAVLINK::var_info[] = {
     // @RebootRequired: True
     // @User: Advanced
     AP_GROUPINFO("_ADSB",   10, GCS_MAVLINK, streamRates[GCS_MAVLINK::STREAM_ADSB], DRATE(GCS_MAVLINK::STREAM_ADSB)),
+
+#if AP_MAVLINK_BW_SCHEDULER_ENABLED
+    // @Param: _BW_PCT
+    // @DisplayName: Stream bandwidth limit
+    // @Description: Percentage of the link bandwidth that streamed messages may use. Streams are paced with a token bucket sized from the port baudrate, which backs off when RADIO_STATUS reports a filling radio buffer or the port transmit buffer fills. When several streams are due the slowest is sent first so high rate streams cannot starve status messages. Heartbeats, parameters and other explicitly sent messages are not held back but do count against the limit. Zero disables the scheduler and uses the RADIO_STATUS stream slowdown instead.
+    // @Units: %
+    // @Range: 0 100
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_BW_PCT",  11, GCS_MAVLINK, bw_pct, 0),
+#endif
     AP_GROUPEND
 };
 #undef DRATE
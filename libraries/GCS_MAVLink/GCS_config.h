@@ -47,6 +47,11 @@
 #define HAL_MAVLINK_INTERVALS_FROM_FILES_ENABLED ((AP_FILESYSTEM_FATFS_ENABLED || AP_FILESYSTEM_LITTLEFS_ENABLED || AP_FILESYSTEM_POSIX_ENABLED) && HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
 #endif
 
+// token bucket scheduling of streamed messages within the link bandwidth
+#ifndef AP_MAVLINK_BW_SCHEDULER_ENABLED
+#define AP_MAVLINK_BW_SCHEDULER_ENABLED HAL_GCS_ENABLED && HAL_PROGRAM_SIZE_LIMIT_KB > 1024
+#endif
+
 #ifndef AP_MAVLINK_MSG_RELAY_STATUS_ENABLED
 #define AP_MAVLINK_MSG_RELAY_STATUS_ENABLED HAL_GCS_ENABLED && AP_RELAY_ENABLED
 #endif
@@ -599,6 +599,7 @@ void Frame::init(const char *frame_str, Battery *_battery)
                                model.motor_pos[i], model.motor_thrust_vec[i], model.yaw_factor[i], true_prop_area,
                                model.mdrag_coef);
     }
+    motor_bank.setup(motors, num_motors);
 
     if (is_zero(model.moment_of_inertia.x) || is_zero(model.moment_of_inertia.y) || is_zero(model.moment_of_inertia.z)) {
         // if no inertia provided, assume 50% of mass on ring around center
@@ -645,15 +646,14 @@ void Frame::calculate_forces(const Aircraft &aircraft,
 
     Vector3f vel_air_bf = aircraft.get_dcm().transposed() * aircraft.get_velocity_air_ef();
 
+    calculate_motor_forces(input, torque, thrust, vel_air_bf, gyro, air_density, battery->get_voltage(), use_drag);
+
+    // simulate motor rpm
     const auto *_sitl = AP::sitl();
-    for (uint8_t i=0; i<num_motors; i++) {
-        Vector3f mtorque, mthrust;
-        motors[i].calculate_forces(input, motor_offset, mtorque, mthrust, vel_air_bf, gyro, air_density, battery->get_voltage(), use_drag);
-        torque += mtorque;
-        thrust += mthrust;
-        // simulate motor rpm
-        if (!is_zero(_sitl->vibe_motor)) {
-            rpm[motor_offset+i] = motors[i].get_command() * AP::sitl()->vibe_motor * 60.0f;
+    if (!is_zero(_sitl->vibe_motor)) {
+        for (uint8_t i=0; i<num_motors; i++) {
+            const float command = motor_bank.enabled() ? motor_bank.get_command(i) : motors[i].get_command();
+            rpm[motor_offset+i] = command * _sitl->vibe_motor * 60.0f;
         }
     }
 
@@ -694,6 +694,27 @@ void Frame::calculate_forces(const Aircraft &aircraft,
 }
 
 
+// calculate total torque and thrust of all motors
+void Frame::calculate_motor_forces(const struct sitl_input &input,
+                                   Vector3f &torque, Vector3f &thrust,
+                                   const Vector3f &vel_air_bf, const Vector3f &gyro,
+                                   float air_density, float voltage, bool use_drag)
+{
+    if (motor_bank.enabled()) {
+        motor_bank.calculate_forces(input, motor_offset, torque, thrust, vel_air_bf, gyro, air_density, voltage, use_drag);
+        return;
+    }
+
+    torque.zero();
+    thrust.zero();
+    for (uint8_t i=0; i<num_motors; i++) {
+        Vector3f mtorque, mthrust;
+        motors[i].calculate_forces(input, motor_offset, mtorque, mthrust, vel_air_bf, gyro, air_density, voltage, use_drag);
+        torque += mtorque;
+        thrust += mthrust;
+    }
+}
+
 // calculate current and voltage
 void Frame::current_and_voltage(float &voltage, float &current)
 {
@@ -703,6 +724,10 @@ void Frame::current_and_voltage(float &voltage, float &current)
         last_param_voltage = param_voltage;
     }
     voltage = battery->get_voltage();
+    if (motor_bank.enabled()) {
+        current = motor_bank.get_current();
+        return;
+    }
     current = 0;
     for (uint8_t i=0; i<num_motors; i++) {
         current += motors[i].get_current();
@@ -21,10 +21,8 @@
 #include "SIM_Aircraft.h"
 #include "SIM_Motor.h"
 #include <AP_JSON/AP_JSON.h>
-
-#ifndef SIM_FRAME_MAX_ACTUATORS
-#define SIM_FRAME_MAX_ACTUATORS 32
-#endif
+#include "SIM_config.h"
+#include "SIM_MotorBank.h"
 
 namespace SITL {
 
@@ -56,6 +54,12 @@ public:
                           const struct sitl_input &input,
                           Vector3f &rot_accel, Vector3f &body_accel, float* rpm,
                           bool use_drag=true);
+
+    // calculate total torque and thrust of all motors
+    void calculate_motor_forces(const struct sitl_input &input,
+                                Vector3f &torque, Vector3f &thrust,
+                                const Vector3f &vel_air_bf, const Vector3f &gyro,
+                                float air_density, float voltage, bool use_drag);
 #endif // AP_SIM_ENABLED
 
     float terminal_velocity;
@@ -163,6 +167,9 @@ private:
     Battery *battery;
 #endif
 
+    // all motors in one pass, used when no motors can tilt
+    MotorBank motor_bank;
+
     // json parsing helpers
     void parse_float(AP_JSON::value val, const char* label, float &param);
     void parse_vector3(AP_JSON::value val, const char* label, Vector3f &param);
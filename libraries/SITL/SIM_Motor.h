@@ -123,6 +123,9 @@ public:
     float calc_thrust(float command, float air_density, float velocity_in, float voltage_scale) const;
 
 private:
+    // the struct-of-arrays model copies the motor setup
+    friend class MotorBank;
+
     float mot_pwm_min;
     float mot_pwm_max;
     float mot_spin_min;
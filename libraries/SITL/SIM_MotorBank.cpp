@@ -0,0 +1,180 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  struct-of-arrays motor model
+*/
+
+#include "SIM_MotorBank.h"
+
+using namespace SITL;
+
+/*
+  copy motor setup into the bank
+ */
+bool MotorBank::setup(const Motor *motors, uint8_t _num_motors)
+{
+    num_motors = 0;
+    if (_num_motors == 0 || _num_motors > SIM_FRAME_MAX_ACTUATORS) {
+        return false;
+    }
+    for (uint8_t i=0; i<_num_motors; i++) {
+        if (motors[i].roll_servo >= 0 || motors[i].pitch_servo >= 0) {
+            // tilting motors need the full per-motor model
+            return false;
+        }
+    }
+
+    const Motor &m = motors[0];
+    const float pwm_thrust_max = m.mot_pwm_min + m.mot_spin_max * (m.mot_pwm_max - m.mot_pwm_min);
+    pwm_thrust_min = m.mot_pwm_min + m.mot_spin_min * (m.mot_pwm_max - m.mot_pwm_min);
+    pwm_thrust_range = pwm_thrust_max - pwm_thrust_min;
+    expo = m.mot_expo;
+    slew_max = m.slew_max;
+    voltage_max = m.voltage_max;
+    effective_prop_area = m.effective_prop_area;
+    max_outflow_velocity = m.max_outflow_velocity;
+    true_prop_area = m.true_prop_area;
+    momentum_drag_coefficient = m.momentum_drag_coefficient;
+    power_factor = m.power_factor;
+    yaw_scale = 0.05 * m.diagonal_size;
+
+    for (uint8_t i=0; i<_num_motors; i++) {
+        const Motor &mi = motors[i];
+        servo[i] = mi.servo;
+        pos_x[i] = mi.position.x;
+        pos_y[i] = mi.position.y;
+        pos_z[i] = mi.position.z;
+        thrust_vec_x[i] = mi.thrust_vector.x;
+        thrust_vec_y[i] = mi.thrust_vector.y;
+        thrust_vec_z[i] = mi.thrust_vector.z;
+        thrust_vec_inv_length_sq[i] = 1.0 / mi.thrust_vector.length_squared();
+        yaw_factor[i] = mi.yaw_factor;
+        command[i] = 0;
+        current[i] = 0;
+    }
+    last_calc_us = 0;
+    num_motors = _num_motors;
+
+    return true;
+}
+
+/*
+  calculate total rotational accel and thrust for all motors. This is
+  the same model as Motor::calculate_forces() with the loop body kept
+  free of calls and branches so the compiler can vectorise it
+ */
+void MotorBank::calculate_forces(const struct sitl_input &input,
+                                 uint8_t motor_offset,
+                                 Vector3f &torque,
+                                 Vector3f &thrust,
+                                 const Vector3f &velocity_air_bf,
+                                 const Vector3f &gyro,
+                                 float air_density,
+                                 float voltage,
+                                 bool use_drag)
+{
+    torque.zero();
+    thrust.zero();
+
+    const float voltage_scale = voltage / voltage_max;
+    if (voltage_scale < 0.1) {
+        // battery is dead
+        for (uint8_t i=0; i<num_motors; i++) {
+            current[i] = 0;
+        }
+        return;
+    }
+
+    // slew limit is common to all motors. Commands are in the range
+    // 0 to 1 so a change of 1 is no limit at all
+    const uint64_t now_us = AP_HAL::micros64();
+    float slew_max_change = 1;
+    if (last_calc_us != 0 && slew_max > 0) {
+        slew_max_change = slew_max * (now_us - last_calc_us) * 1.0e-6;
+    }
+    last_calc_us = now_us;
+
+    // gather PWM inputs
+    for (uint8_t i=0; i<num_motors; i++) {
+        pwm[i] = input.servos[motor_offset+servo[i]];
+    }
+
+    const float thrust_scale = 0.5 * air_density * effective_prop_area;
+    const float velocity_out_max_sq = sq(voltage_scale * max_outflow_velocity);
+    const float momentum_drag_factor = use_drag ? momentum_drag_coefficient * sqrtf(air_density * true_prop_area) : 0;
+    const float current_scale = power_factor / MAX(voltage, 0.1);
+
+    float torque_x = 0, torque_y = 0, torque_z = 0;
+    float thrust_x = 0, thrust_y = 0, thrust_z = 0;
+
+    for (uint8_t i=0; i<num_motors; i++) {
+        // convert PWM to command and apply slew limiter
+        float c = (pwm[i] - pwm_thrust_min) / pwm_thrust_range;
+        c = fminf(fmaxf(c, 0), 1);
+        c = fminf(fmaxf(c, command[i] - slew_max_change), command[i] + slew_max_change);
+        command[i] = c;
+
+        // velocity of motor through air, including rotation about center
+        const float vel_x = velocity_air_bf.x - (pos_y[i]*gyro.z - pos_z[i]*gyro.y);
+        const float vel_y = velocity_air_bf.y - (pos_z[i]*gyro.x - pos_x[i]*gyro.z);
+        const float vel_z = velocity_air_bf.z - (pos_x[i]*gyro.y - pos_y[i]*gyro.x);
+
+        // velocity into prop, clipping at zero
+        const float proj = (vel_x*thrust_vec_x[i] + vel_y*thrust_vec_y[i] + vel_z*thrust_vec_z[i]) * thrust_vec_inv_length_sq[i];
+        const float velocity_in = fmaxf(-proj * thrust_vec_z[i], 0);
+
+        // thrust of untilted motor, see Motor::calc_thrust()
+        const float motor_thrust = thrust_scale * (velocity_out_max_sq * ((1-expo)*c + expo*c*c) - velocity_in*velocity_in);
+
+        // thrust in bodyframe NED
+        float mthrust_x = thrust_vec_x[i] * motor_thrust;
+        float mthrust_y = thrust_vec_y[i] * motor_thrust;
+        float mthrust_z = thrust_vec_z[i] * motor_thrust;
+
+        // momentum drag, zero when drag is disabled
+        const float sqrt_x = sqrtf(fabsf(mthrust_x));
+        const float sqrt_y = sqrtf(fabsf(mthrust_y));
+        const float sqrt_z = sqrtf(fabsf(mthrust_z));
+        mthrust_x -= momentum_drag_factor * vel_x * (sqrt_y + sqrt_z);
+        mthrust_y -= momentum_drag_factor * vel_y * (sqrt_x + sqrt_z);
+        mthrust_z -= momentum_drag_factor * vel_z * (sqrt_x + sqrt_y + sqrt_z);
+
+        // yaw torque of the motor
+        const float rotor_torque = -yaw_factor[i] * c * yaw_scale * motor_thrust;
+
+        torque_x += pos_y[i]*mthrust_z - pos_z[i]*mthrust_y + thrust_vec_x[i]*rotor_torque;
+        torque_y += pos_z[i]*mthrust_x - pos_x[i]*mthrust_z + thrust_vec_y[i]*rotor_torque;
+        torque_z += pos_x[i]*mthrust_y - pos_y[i]*mthrust_x + thrust_vec_z[i]*rotor_torque;
+
+        thrust_x += mthrust_x;
+        thrust_y += mthrust_y;
+        thrust_z += mthrust_z;
+
+        current[i] = fabsf(motor_thrust) * current_scale;
+    }
+
+    torque = Vector3f(torque_x, torque_y, torque_z);
+    thrust = Vector3f(thrust_x, thrust_y, thrust_z);
+}
+
+// get total current of all motors
+float MotorBank::get_current(void) const
+{
+    float ret = 0;
+    for (uint8_t i=0; i<num_motors; i++) {
+        ret += current[i];
+    }
+    return ret;
+}
@@ -0,0 +1,97 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  struct-of-arrays motor model, computing the forces from all the
+  fixed (non-tilting) motors of a frame in a single pass
+*/
+
+#pragma once
+
+#include "SIM_Motor.h"
+#include "SIM_config.h"
+
+namespace SITL {
+
+class MotorBank {
+public:
+    /*
+      copy the setup of an array of motors into the bank. All motors
+      must share the parameters given to Motor::setup_params() apart
+      from position, thrust vector and yaw factor, as is done by
+      Frame::init(). Returns false if any of the motors can tilt, in
+      which case the per-motor model must be used
+     */
+    bool setup(const Motor *motors, uint8_t _num_motors);
+
+    // true if setup() succeeded
+    bool enabled(void) const {
+        return num_motors > 0;
+    }
+
+    // calculate the total torque and thrust of all motors, same
+    // conventions as Motor::calculate_forces()
+    void calculate_forces(const struct sitl_input &input,
+                          uint8_t motor_offset,
+                          Vector3f &torque, // Newton meters
+                          Vector3f &thrust, // Z is down, Newtons
+                          const Vector3f &velocity_air_bf,
+                          const Vector3f &gyro, // rad/sec
+                          float air_density,
+                          float voltage,
+                          bool use_drag);
+
+    // get slew limited command from 0 to 1 for a motor
+    float get_command(uint8_t i) const {
+        return command[i];
+    }
+
+    // get total current of all motors
+    float get_current(void) const;
+
+private:
+    uint8_t num_motors;
+
+    // parameters shared by all motors
+    float pwm_thrust_min;
+    float pwm_thrust_range;
+    float expo;
+    float slew_max;
+    float voltage_max;
+    float effective_prop_area;
+    float max_outflow_velocity;
+    float true_prop_area;
+    float momentum_drag_coefficient;
+    float power_factor;
+    float yaw_scale;
+
+    // per-motor geometry, one array per component
+    uint8_t servo[SIM_FRAME_MAX_ACTUATORS];
+    float pos_x[SIM_FRAME_MAX_ACTUATORS];
+    float pos_y[SIM_FRAME_MAX_ACTUATORS];
+    float pos_z[SIM_FRAME_MAX_ACTUATORS];
+    float thrust_vec_x[SIM_FRAME_MAX_ACTUATORS];
+    float thrust_vec_y[SIM_FRAME_MAX_ACTUATORS];
+    float thrust_vec_z[SIM_FRAME_MAX_ACTUATORS];
+    float thrust_vec_inv_length_sq[SIM_FRAME_MAX_ACTUATORS];
+    float yaw_factor[SIM_FRAME_MAX_ACTUATORS];
+
+    // per-motor state
+    float pwm[SIM_FRAME_MAX_ACTUATORS];
+    float command[SIM_FRAME_MAX_ACTUATORS];
+    float current[SIM_FRAME_MAX_ACTUATORS];
+    uint64_t last_calc_us;
+};
+
+}
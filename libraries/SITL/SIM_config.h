@@ -5,6 +5,11 @@
 
 #define AP_SIM_MAX_GPS_SENSORS 4
 
+// most motors and servos in a simulated multicopter frame
+#ifndef SIM_FRAME_MAX_ACTUATORS
+#define SIM_FRAME_MAX_ACTUATORS 32
+#endif
+
 #ifndef HAL_SIM_ADSB_ENABLED
 #define HAL_SIM_ADSB_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
 #endif
@@ -0,0 +1,76 @@
+#include <AP_gbenchmark.h>
+
+#include <SITL/SIM_Frame.h>
+#include <SITL/SIM_Battery.h>
+
+// cost of a frame update, run from the top of the source tree so the json model can be found
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const char *frame_names[] = {
+    "quad",
+    "hexa",
+    "octa",
+    "dodeca-hexa",
+    "dotriaconta",
+    "octa-quad:Tools/autotest/models/Callisto.json",
+};
+
+static SITL::Battery battery;
+
+static SITL::Frame *setup_frame(benchmark::State &state, struct sitl_input &input)
+{
+    const char *name = frame_names[state.range(0)];
+    SITL::Frame *frame = SITL::Frame::find_frame(name);
+    frame->init(name, &battery);
+    state.SetLabel(name);
+
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = 1400 + (i * 37) % 300;
+    }
+    return frame;
+}
+
+static const Vector3f vel_air_bf{5, -1, 0.5};
+static const Vector3f gyro{0.1, -0.2, 0.05};
+static const float air_density = 1.2;
+static const float voltage = 50;
+
+// the original model, one motor at a time
+static void BM_FramePerMotor(benchmark::State& state)
+{
+    struct sitl_input input {};
+    SITL::Frame *frame = setup_frame(state, input);
+
+    while (state.KeepRunning()) {
+        Vector3f torque, thrust;
+        for (uint8_t i=0; i<frame->num_motors; i++) {
+            Vector3f mtorque, mthrust;
+            frame->motors[i].calculate_forces(input, frame->motor_offset, mtorque, mthrust,
+                                              vel_air_bf, gyro, air_density, voltage, true);
+            torque += mtorque;
+            thrust += mthrust;
+        }
+        gbenchmark_escape(&torque);
+        gbenchmark_escape(&thrust);
+    }
+}
+
+// the frame model, all motors in one pass when possible
+static void BM_FrameMotorBank(benchmark::State& state)
+{
+    struct sitl_input input {};
+    SITL::Frame *frame = setup_frame(state, input);
+
+    while (state.KeepRunning()) {
+        Vector3f torque, thrust;
+        frame->calculate_motor_forces(input, torque, thrust, vel_air_bf, gyro, air_density, voltage, true);
+        gbenchmark_escape(&torque);
+        gbenchmark_escape(&thrust);
+    }
+}
+
+BENCHMARK(BM_FramePerMotor)->DenseRange(0, ARRAY_SIZE(frame_names)-1);
+BENCHMARK(BM_FrameMotorBank)->DenseRange(0, ARRAY_SIZE(frame_names)-1);
+
+BENCHMARK_MAIN();
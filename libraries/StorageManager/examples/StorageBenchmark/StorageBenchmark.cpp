@@ -0,0 +1,127 @@
+//
+// Benchmark of storage writes, using the access patterns of a mission
+// upload and a full parameter save, timing the StorageAccess writes
+// and the HAL writing its dirty lines out to the storage backend.
+// Build with STORAGE_FLUSH_LINES=1 defined to compare against writing
+// one line at a time
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <StorageManager/StorageManager.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static StorageAccess mission_storage(StorageManager::StorageMission);
+static StorageAccess param_storage(StorageManager::StorageParam);
+
+// matches AP_MISSION_EEPROM_COMMAND_SIZE
+static const uint16_t mission_item_size = 15;
+static const uint16_t mission_items = 700;
+
+/*
+  run the HAL storage flush until all dirty lines are written. There
+  is at most one dirty line per 8 bytes of storage
+ */
+static uint32_t drain_us(void)
+{
+    const uint32_t t0 = AP_HAL::micros();
+    for (uint32_t i=0; i<HAL_STORAGE_SIZE/8; i++) {
+        hal.storage->_timer_tick();
+    }
+    return AP_HAL::micros() - t0;
+}
+
+static void print_stats(const char *name, uint32_t write_us, uint32_t flush_us)
+{
+    hal.console->printf("%s: %u us writing, %u us flushing\n",
+                        name, (unsigned)write_us, (unsigned)flush_us);
+}
+
+/*
+  write mission items the way AP_Mission::write_cmd_to_storage does
+ */
+static void bench_mission_upload(void)
+{
+    const uint16_t count = MIN(mission_items, uint16_t((mission_storage.size() - 4) / mission_item_size));
+    uint8_t content[12] {};
+
+    const uint32_t t0 = AP_HAL::micros();
+    for (uint16_t i=0; i<count; i++) {
+        const uint16_t pos = 4 + i * mission_item_size;
+        content[0] = i & 0xFF;
+        mission_storage.write_byte(pos, 16);
+        mission_storage.write_uint16(pos+1, 0);
+        mission_storage.write_block(pos+3, content, sizeof(content));
+    }
+    // the saved count of items, as the queued save of MIS_TOTAL does
+    param_storage.write_uint16(param_storage.size() - 2, count);
+    const uint32_t t1 = AP_HAL::micros();
+    const uint32_t t2 = t1 + drain_us();
+
+    hal.console->printf("Mission upload of %u items\n", (unsigned)count);
+    print_stats("mission", t1 - t0, t2 - t1);
+}
+
+/*
+  save every parameter the way AP_Param::save_sync does: a 4 byte
+  header, the value and a new sentinel after it
+ */
+static void bench_param_save(void)
+{
+    const uint16_t record_size = 4 + sizeof(float);
+    const uint16_t count = (param_storage.size() - 8 - 4) / record_size;
+
+    const uint32_t t0 = AP_HAL::micros();
+    for (uint16_t i=0; i<count; i++) {
+        const uint16_t ofs = 4 + i * record_size;
+        const uint32_t header = 0x00010000U | i;
+        const uint32_t sentinel = 0xFFFFFFFFU;
+        const float value = i;
+        param_storage.write_block(ofs + record_size, &sentinel, sizeof(sentinel));
+        param_storage.write_block(ofs + 4, &value, sizeof(value));
+        param_storage.write_block(ofs, &header, sizeof(header));
+    }
+    const uint32_t t1 = AP_HAL::micros();
+    const uint32_t t2 = t1 + drain_us();
+
+    hal.console->printf("Parameter save of %u parameters\n", (unsigned)count);
+    print_stats("params", t1 - t0, t2 - t1);
+}
+
+/*
+  read everything back through StorageAccess to check nothing was lost
+ */
+static void check_mission(void)
+{
+    const uint16_t count = MIN(mission_items, uint16_t((mission_storage.size() - 4) / mission_item_size));
+    for (uint16_t i=0; i<count; i++) {
+        const uint16_t pos = 4 + i * mission_item_size;
+        if (mission_storage.read_byte(pos) != 16 ||
+            mission_storage.read_byte(pos+3) != (i & 0xFF)) {
+            hal.console->printf("mission item %u bad\n", (unsigned)i);
+            return;
+        }
+    }
+    hal.console->printf("mission readback OK\n");
+}
+
+void setup(void)
+{
+    hal.console->printf("StorageBenchmark startup...\n");
+    hal.scheduler->delay(1000);
+
+    bench_mission_upload();
+    check_mission();
+    bench_param_save();
+}
+
+void loop(void)
+{
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();